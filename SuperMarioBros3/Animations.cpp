@@ -3,8 +3,8 @@
 #include "HUD.h"
 #include "PlayScence.h"
 #include "IntroScene.h"
-
-CAnimationSets * CAnimationSets::__instance = NULL;
+#include "World.h"
+#include "Snapshot.h"
 
 void CAnimation::Add(int spriteId, DWORD time)
 {
@@ -26,7 +26,7 @@ void CAnimation::Add(int spriteId, DWORD time)
 // NOTE: sometimes Animation object is NULL ??? HOW ??? 
 void CAnimation::Render(float x, float y, int alpha)
 {
-	DWORD now = (DWORD)GetTickCount64();
+	DWORD now = (DWORD)CGame::GetInstance()->GetSceneTime();
 	if (currentFrame == -1)
 	{
 		currentFrame = 0;
@@ -52,12 +52,9 @@ void CAnimation::Render(float x, float y, int alpha)
 	}
 }
 
-CAnimations * CAnimations::__instance = NULL;
-
 CAnimations * CAnimations::GetInstance()
 {
-	if (__instance == NULL) __instance = new CAnimations();
-	return __instance;
+	return &CWorld::GetCurrent()->animations;
 }
 
 void CAnimations::Add(int id, LPANIMATION ani)
@@ -74,6 +71,43 @@ LPANIMATION CAnimations::Get(int id)
 	return ani;
 }
 
+void CAnimation::Save(CSnapshot& s)
+{
+	s.Write(lastFrameTime);
+	s.Write(currentFrame);
+}
+
+void CAnimation::Load(CSnapshot& s)
+{
+	s.Read(lastFrameTime);
+	s.Read(currentFrame);
+}
+
+void CAnimations::Save(CSnapshot& s)
+{
+	s.Write(animations.size());
+	for (auto x : animations)
+	{
+		s.Write(x.second);
+		if (x.second != NULL)
+			x.second->Save(s);
+	}
+}
+
+// Get adds the ids it misses, the map may have changed order since the save
+void CAnimations::Load(CSnapshot& s)
+{
+	size_t n;
+	s.Read(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		LPANIMATION ani;
+		s.Read(ani);
+		if (ani != NULL)
+			ani->Load(s);
+	}
+}
+
 void CAnimations::Clear()
 {
 	for (auto x : animations)
@@ -92,8 +126,7 @@ CAnimationSets::CAnimationSets()
 
 CAnimationSets *CAnimationSets::GetInstance()
 {
-	if (__instance == NULL) __instance = new CAnimationSets();
-	return __instance;
+	return &CWorld::GetCurrent()->animationSets;
 }
 
 LPANIMATION_SET CAnimationSets::Get(unsigned int id)
@@ -1,10 +1,12 @@
 #pragma once
 #include <Windows.h>
-#include <d3dx9.h>
 #include <unordered_map>
+#include <vector>
 
 #include "Sprites.h"
 
+class CSnapshot;
+
 /*
 Sprite animation
 */
@@ -32,13 +34,15 @@ public:
 	void Add(int spriteId, DWORD time = 0);
 
 	void Render(float x, float y, int alpha = 255);
+
+	void Save(CSnapshot& s);
+	void Load(CSnapshot& s);
 };
 
 typedef CAnimation *LPANIMATION;
 
 class CAnimations
 {
-	static CAnimations * __instance;
 
 	unordered_map<int, LPANIMATION> animations;
 
@@ -47,6 +51,10 @@ public:
 	LPANIMATION Get(int id);
 	void Clear();
 
+	// frame each animation is at, shared by the objects drawing it
+	void Save(CSnapshot& s);
+	void Load(CSnapshot& s);
+
 	static CAnimations * GetInstance();
 };
 
@@ -59,7 +67,6 @@ typedef CAnimationSet* LPANIMATION_SET;
 */
 class CAnimationSets
 {
-	static CAnimationSets * __instance;
 
 	unordered_map<int, LPANIMATION_SET> animation_sets;
 
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "AtlasPacker.h"
+#include "Game.h"
+#include "Textures.h"
+#include "Utils.h"
+
+struct CAtlasImage
+{
+	LPTEXTURE source;
+	int left, top, right, bottom;
+	int atlas;
+	int x, y;
+};
+
+void CAtlasPacker::AddAll(CSprites* sprites)
+{
+	sprites->ForEach([this](LPSPRITE s) { Add(s); });
+}
+
+int CAtlasPacker::Pack()
+{
+	// each image once, an image is the part of a sheet a sprite shows
+	map<tuple<LPTEXTURE, int, int, int, int>, int> imageIds;
+	vector<CAtlasImage> images;
+	vector<int> spriteImage(sprites.size(), -1);
+	for (size_t i = 0; i < sprites.size(); i++)
+	{
+		LPTEXTURE tex = sprites[i]->GetTexture();
+		int l, t, r, b;
+		sprites[i]->GetRect(l, t, r, b);
+
+		// off the sheet or too big, it keeps drawing from its sheet
+		if (tex == NULL || l < 0 || t < 0 || r > tex->width || b > tex->height || r <= l || b <= t)
+			continue;
+		if (r - l + ATLAS_PADDING > ATLAS_WIDTH || b - t + ATLAS_PADDING > ATLAS_MAX_HEIGHT)
+			continue;
+
+		auto key = make_tuple(tex, l, t, r, b);
+		auto found = imageIds.find(key);
+		if (found == imageIds.end())
+		{
+			CAtlasImage image = { tex, l, t, r, b, -1, 0, 0 };
+			found = imageIds.insert(make_pair(key, (int)images.size())).first;
+			images.push_back(image);
+		}
+		spriteImage[i] = found->second;
+	}
+	if (images.empty())
+		return 0;
+
+	vector<int> order(images.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = (int)i;
+	stable_sort(order.begin(), order.end(), [&images](int a, int b)
+	{
+		int ha = images[a].bottom - images[a].top, hb = images[b].bottom - images[b].top;
+		return ha > hb;
+	});
+
+	// rows left to right, a new row under the tallest image of the last, a new atlas when full
+	vector<int> atlasHeights;
+	int x = ATLAS_PADDING, y = ATLAS_PADDING, rowHeight = 0;
+	int atlas = 0;
+	atlasHeights.push_back(0);
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		CAtlasImage& image = images[order[i]];
+		int w = image.right - image.left, h = image.bottom - image.top;
+		if (x + w + ATLAS_PADDING > ATLAS_WIDTH)
+		{
+			x = ATLAS_PADDING;
+			y += rowHeight + ATLAS_PADDING;
+			rowHeight = 0;
+		}
+		if (y + h + ATLAS_PADDING > ATLAS_MAX_HEIGHT)
+		{
+			atlas++;
+			atlasHeights.push_back(0);
+			x = y = ATLAS_PADDING;
+			rowHeight = 0;
+		}
+		image.atlas = atlas;
+		image.x = x;
+		image.y = y;
+		x += w + ATLAS_PADDING;
+		rowHeight = max(rowHeight, h);
+		atlasHeights[atlas] = max(atlasHeights[atlas], y + h + ATLAS_PADDING);
+	}
+
+	LPRENDERER renderer = CGame::GetInstance()->GetRenderer();
+	vector<LPTEXTURE> atlases;
+	vector<CAtlasCopy> copies;
+	for (size_t a = 0; a < atlasHeights.size(); a++)
+	{
+		copies.clear();
+		for (size_t i = 0; i < images.size(); i++)
+			if (images[i].atlas == (int)a)
+			{
+				CAtlasImage& image = images[i];
+				CAtlasCopy c = { image.source, image.left, image.top, image.right, image.bottom, image.x, image.y };
+				copies.push_back(c);
+			}
+
+		// a power of two tall, the way the older cards want textures
+		int height = 1;
+		while (height < atlasHeights[a])
+			height *= 2;
+
+		LPTEXTURE tex = renderer->CreateAtlas(ATLAS_WIDTH, height, copies);
+		if (tex == NULL)
+		{
+			for (size_t j = 0; j < atlases.size(); j++)
+				delete atlases[j];
+			DebugOut(L"[INFO] The renderer makes no atlases, sprites draw from their sheets\n");
+			return 0;
+		}
+		atlases.push_back(tex);
+	}
+
+	for (size_t a = 0; a < atlases.size(); a++)
+		CTextures::GetInstance()->AddAtlas(atlases[a]);
+	for (size_t i = 0; i < sprites.size(); i++)
+	{
+		if (spriteImage[i] < 0) continue;
+		CAtlasImage& image = images[spriteImage[i]];
+		sprites[i]->SetImage(atlases[image.atlas], image.x, image.y);
+	}
+
+	DebugOut(L"[INFO] Packed %d images of %d sprites into %d atlases\n",
+		(int)images.size(), (int)sprites.size(), (int)atlases.size());
+	return (int)atlases.size();
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include "Sprites.h"
+
+using namespace std;
+
+#define ATLAS_WIDTH			2048
+#define ATLAS_MAX_HEIGHT	2048
+#define ATLAS_PADDING		1		// transparent pixels between two images, nothing bleeds in when filtering
+
+/*
+	Packs the images of a scene's sprites into a few big textures at load time and points
+	the sprites at them, so a frame draws from one or two textures instead of one per
+	sprite sheet. The images are packed in rows, tallest first, an image used by several
+	sprites only once. The sheets stay loaded, CTextures still hands them out by id.
+*/
+class CAtlasPacker
+{
+	vector<LPSPRITE> sprites;
+
+public:
+	void Add(LPSPRITE sprite) { sprites.push_back(sprite); }
+	void AddAll(CSprites* sprites);
+	void AddAll(vector<LPSPRITE>& sprites) { this->sprites.insert(this->sprites.end(), sprites.begin(), sprites.end()); }
+
+	// atlases made, 0 when the renderer cannot make them (the sprites keep their sheets)
+	int Pack();
+};
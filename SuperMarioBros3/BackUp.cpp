@@ -3,12 +3,11 @@
 #include "Game.h"
 #include "PlayScence.h"
 #include "WorldMap.h"
+#include "World.h"
 
-CBackUp* CBackUp::__instance = NULL;
 CBackUp* CBackUp::GetInstance()
 {
-	if (__instance == NULL) __instance = new CBackUp();
-	return __instance;
+	return &CWorld::GetCurrent()->backUp;
 }
 
 void CBackUp::BackUpMario(CMario* mario)
@@ -1,9 +1,8 @@
 #pragma once
-#include "mario.h"
+#include "Mario.h"
 #include "MarioWM.h"
 class CBackUp
 {
-	static CBackUp* __instance;
 	unsigned int life = 4;
 	unsigned int money = 0;
 	unsigned int points = 0;
@@ -0,0 +1,191 @@
+#include <algorithm>
+
+#include "BatchRenderer.h"
+
+static bool Overlap(float l1, float t1, float r1, float b1, float l2, float t2, float r2, float b2)
+{
+	return l1 < r2 && l2 < r1 && t1 < b2 && t2 < b1;
+}
+
+static bool Overlap(const CBatchQuad& a, const CBatchQuad& b)
+{
+	return Overlap(a.x, a.y, a.x + (a.right - a.left), a.y + (a.bottom - a.top),
+		b.x, b.y, b.x + (b.right - b.left), b.y + (b.bottom - b.top));
+}
+
+CBatchRenderer::CBatchRenderer(LPRENDERER backend)
+{
+	this->backend = backend;
+}
+
+CBatchRenderer::~CBatchRenderer()
+{
+	delete backend;
+}
+
+bool CBatchRenderer::Init(HWND hWnd, int width, int height)
+{
+	return backend->Init(hWnd, width, height);
+}
+
+LPTEXTURE CBatchRenderer::LoadTexture(LPCWSTR filePath, COLOR transparentColor)
+{
+	return backend->LoadTexture(filePath, transparentColor);
+}
+
+LPTEXTURE CBatchRenderer::CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies)
+{
+	return backend->CreateAtlas(width, height, copies);
+}
+
+bool CBatchRenderer::UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies)
+{
+	return backend->UpdateAtlas(atlas, left, top, right, bottom, copies);
+}
+
+void CBatchRenderer::BeginFrame(COLOR background)
+{
+	quads.clear();
+	batches.clear();
+	layer = 0;
+	firstLayerBatch = 0;
+	firstLayerQuad = 0;
+	lastQuadLayer = 0;
+	reordered = false;
+	lastDrawn = NULL;
+	lastSubmitted = NULL;
+	frameStats = CRenderStats();
+
+	backend->BeginFrame(background);
+}
+
+void CBatchRenderer::SetLayer(int layer)
+{
+	if (layer == this->layer)
+		return;
+	this->layer = layer;
+	firstLayerBatch = (int)batches.size();
+	firstLayerQuad = (int)quads.size();
+}
+
+/*
+	Latest batch of the quad's texture it can join without being drawn under a quad it
+	was drawn over, -1 when it has to start a new one
+*/
+int CBatchRenderer::FindBatch(const CBatchQuad& q)
+{
+	float r = q.x + (q.right - q.left), b = q.y + (q.bottom - q.top);
+	for (int j = (int)batches.size() - 1; j >= firstLayerBatch; j--)
+	{
+		CBatch& batch = batches[j];
+		if (batch.texture == q.texture)
+			return j;
+		if (!Overlap(batch.l, batch.t, batch.r, batch.b, q.x, q.y, r, b))
+			continue;
+
+		for (size_t i = firstLayerQuad; i < quads.size(); i++)
+			if (quads[i].batch == j && Overlap(quads[i], q))
+				return -1;
+	}
+	return -1;
+}
+
+void CBatchRenderer::Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha)
+{
+	CBatchQuad q;
+	q.layer = layer;
+	q.texture = texture;
+	q.x = x;
+	q.y = y;
+	q.left = left;
+	q.top = top;
+	q.right = right;
+	q.bottom = bottom;
+	q.alpha = alpha;
+
+	if (frameStats.quads > 0 && texture != lastDrawn)
+		frameStats.textureSwitchesSubmitted++;
+	frameStats.quads++;
+	lastDrawn = texture;
+
+	if (!enabled)
+	{
+		Submit(q);
+		return;
+	}
+
+	float r = x + (right - left), b = y + (bottom - top);
+	q.batch = FindBatch(q);
+	if (q.batch < 0)
+	{
+		CBatch batch;
+		batch.texture = texture;
+		batch.layer = layer;
+		batch.l = x; batch.t = y; batch.r = r; batch.b = b;
+		q.batch = (int)batches.size();
+		batches.push_back(batch);
+	}
+	else
+	{
+		if (q.batch != (int)batches.size() - 1 || layer < lastQuadLayer)
+			reordered = true;
+		CBatch& batch = batches[q.batch];
+		batch.l = min(batch.l, x);
+		batch.t = min(batch.t, y);
+		batch.r = max(batch.r, r);
+		batch.b = max(batch.b, b);
+	}
+	if (layer < lastQuadLayer)
+		reordered = true;
+	lastQuadLayer = layer;
+	quads.push_back(q);
+}
+
+/*
+	Send the frame's quads to the backend, layer by layer and batch by batch, each batch
+	keeping the order its quads were drawn in
+*/
+void CBatchRenderer::Flush()
+{
+	// most frames draw their textures in runs already, they go out as they are
+	if (!reordered)
+	{
+		for (size_t i = 0; i < quads.size(); i++)
+			Submit(quads[i]);
+		return;
+	}
+
+	sorted.assign(quads.begin(), quads.end());
+	stable_sort(sorted.begin(), sorted.end(), [](const CBatchQuad& a, const CBatchQuad& b)
+	{
+		return a.layer < b.layer || (a.layer == b.layer && a.batch < b.batch);
+	});
+
+	for (size_t i = 0; i < sorted.size(); i++)
+		Submit(sorted[i]);
+}
+
+void CBatchRenderer::Submit(const CBatchQuad& q)
+{
+	if (frameStats.batches == 0 || q.texture != lastSubmitted)
+	{
+		if (frameStats.batches > 0) frameStats.textureSwitches++;
+		frameStats.batches++;
+	}
+	lastSubmitted = q.texture;
+	backend->Draw(q.texture, q.x, q.y, q.left, q.top, q.right, q.bottom, q.alpha);
+}
+
+void CBatchRenderer::EndFrame()
+{
+	if (enabled)
+		Flush();
+	backend->EndFrame();
+
+	lastFrameStats = frameStats;
+	totalStats.quads += frameStats.quads;
+	totalStats.batches += frameStats.batches;
+	totalStats.textureSwitches += frameStats.textureSwitches;
+	totalStats.textureSwitchesSubmitted += frameStats.textureSwitchesSubmitted;
+	frames++;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include "Renderer.h"
+
+using namespace std;
+
+struct CBatchQuad
+{
+	int layer;
+	int batch;			// index in the frame's batches, draws go out sorted by layer then batch
+	LPTEXTURE texture;
+	float x, y;
+	int left, top, right, bottom;
+	int alpha;
+};
+
+struct CBatch
+{
+	LPTEXTURE texture;
+	int layer;
+	float l, t, r, b;	// screen box around its quads
+};
+
+/*
+	Draw calls of a frame
+*/
+struct CRenderStats
+{
+	int quads = 0;
+	int batches = 0;					// draws sent to the backend in a row with the same texture
+	int textureSwitches = 0;			// texture changes between two draws sent to the backend
+	int textureSwitchesSubmitted = 0;	// the same in the order the game drew, without batching
+};
+
+/*
+	Records the draws of a frame and sends them to the renderer it wraps (owned, deleted
+	with it) at EndFrame, grouped by layer and then by texture so the backend switches
+	textures as little as possible.
+
+	A draw joins the latest batch of its texture in its layer unless a draw of another
+	texture recorded after that batch overlaps it; then it starts a new batch. Draws
+	change order only when they do not overlap, so the frame looks exactly the same as
+	without batching.
+*/
+class CBatchRenderer : public CRenderer
+{
+	LPRENDERER backend;
+	bool enabled = true;
+
+	vector<CBatchQuad> quads;
+	vector<CBatch> batches;
+	vector<CBatchQuad> sorted;
+	int layer = 0;
+	int firstLayerBatch = 0;	// first batch of the current layer
+	int firstLayerQuad = 0;
+	int lastQuadLayer = 0;
+	bool reordered = false;		// a quad joined a batch before the last one, or a layer below the last
+	LPTEXTURE lastDrawn = NULL;			// texture of the game's last draw
+	LPTEXTURE lastSubmitted = NULL;		// texture of the last draw sent to the backend
+
+	CRenderStats frameStats;
+	CRenderStats lastFrameStats;
+	CRenderStats totalStats;
+	int frames = 0;
+
+	int FindBatch(const CBatchQuad& q);
+	void Submit(const CBatchQuad& q);
+	void Flush();
+
+public:
+	CBatchRenderer(LPRENDERER backend);
+	~CBatchRenderer();
+
+	bool Init(HWND hWnd, int width, int height);
+	LPTEXTURE LoadTexture(LPCWSTR filePath, COLOR transparentColor);
+	LPTEXTURE CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies);
+	bool UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies);
+
+	void BeginFrame(COLOR background);
+	void Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha);
+	void EndFrame();
+
+	void SetLayer(int layer);
+
+	// off, draws go through to the backend as they come (the stats still count them)
+	void SetEnabled(bool enabled) { this->enabled = enabled; }
+
+	LPRENDERER GetBackend() { return backend; }
+	CRenderStats GetLastFrameStats() { return lastFrameStats; }
+	CRenderStats GetTotalStats() { return totalStats; }
+	int GetFrames() { return frames; }
+};
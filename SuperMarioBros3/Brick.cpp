@@ -3,6 +3,7 @@
 
 CBrick::CBrick(float _x, float _y, int _type)
 {
+	kind = OBJECT_KIND_BRICK;
 	this->type = _type;
 }
 
@@ -19,7 +20,7 @@ void CBrick::GetBoundingBox(float &l, float &t, float &r, float &b)
 {
 	l = x;
 	t = y;
-	r = x + BRICK_BBOX_WIDTH;
-	b = y + BRICK_BBOX_HEIGHT;
+	r = x + width;
+	b = y + height;
 }
 
@@ -17,10 +17,13 @@ class CBrick : public CGameObject
 {
 private:
 	int type;
+	float width = BRICK_BBOX_WIDTH;		// bigger than a tile when neighbour bricks are merged
+	float height = BRICK_BBOX_HEIGHT;
 public:
 	CBrick(float _x, float _y, int _Type);
 	virtual void Render();
 	virtual void GetBoundingBox(float &l, float &t, float &r, float &b);
 
 	int GetType() { return this->type; }
+	void SetSize(float _width, float _height) { width = _width; height = _height; }
 };
\ No newline at end of file
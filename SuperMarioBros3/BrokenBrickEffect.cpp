@@ -1,4 +1,6 @@
 #include "BrokenBrickEffect.h"
+#include "Game.h"
+#include "Snapshot.h"
 CBrokenBrickEffect::CBrokenBrickEffect(float _x, float _y)
 {
 	this->x = _x;
@@ -19,7 +21,7 @@ CBrokenBrickEffect::CBrokenBrickEffect(float _x, float _y)
 
 void CBrokenBrickEffect::StartAppear()
 {
-	appear_start = (DWORD)GetTickCount64();
+	appear_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 	IsAppearing = true;
 
 	vx = BROKEN_BRICK_EFFECT_SPEED_X;
@@ -59,6 +61,25 @@ void CBrokenBrickEffect::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 	vy2 += dt * BRICK_FRAGMENT_GRAVITY;
 
 
-	if (GetTickCount64() - appear_start > BROKEN_BRICK_EFFECT_APPEAR_TIME && IsAppearing)
+	if (CGame::GetInstance()->GetSceneTime() - appear_start > BROKEN_BRICK_EFFECT_APPEAR_TIME && IsAppearing)
 		IsAppearing = false;
 }
+
+void CBrokenBrickEffect::SaveContainers(CSnapshot& s)
+{
+	CGameObject::SaveContainers(s);
+	s.WriteVector(brokenBrickSprite);
+}
+
+void CBrokenBrickEffect::ReleaseContainers()
+{
+	CGameObject::ReleaseContainers();
+	vector<LPSPRITE>().swap(brokenBrickSprite);
+}
+
+void CBrokenBrickEffect::LoadContainers(CSnapshot& s)
+{
+	CGameObject::LoadContainers(s);
+	new (&brokenBrickSprite) vector<LPSPRITE>();
+	s.ReadVector(brokenBrickSprite);
+}
@@ -26,5 +26,9 @@ public:
 
 	CBrokenBrickEffect(float x, float y);
 	void StartAppear();
+
+	virtual void SaveContainers(CSnapshot& s);
+	virtual void ReleaseContainers();
+	virtual void LoadContainers(CSnapshot& s);
 };
 
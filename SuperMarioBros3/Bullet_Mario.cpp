@@ -6,6 +6,7 @@
 
 CBullet_Mario::CBullet_Mario(float _x, float _y) :CBullet(_x,_y)
 {
+	kind = OBJECT_KIND_BULLET_MARIO;
 	state = BULLET_STATE_FLYING;
 	StartExplode_time = (DWORD)0;
 }
@@ -20,8 +21,6 @@ void CBullet_Mario::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 		vy = BULLET_MARIO_MAX_FALLING_SPEED;
 
 
-	vector<LPCOLLISIONEVENT> coEvents;
-	vector<LPCOLLISIONEVENT> coEventsResult;
 
 	coEvents.clear();
 	CalcPotentialCollisions(coObjects, coEvents);
@@ -43,50 +42,12 @@ void CBullet_Mario::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 		float x0 = x, y0 = y;
 		x = x0 + dx;
 		y = y0 + dy;
+		CCollisionContext c(min_tx, min_ty, nx, ny, x0, y0);
 		for (UINT i = 0; i < coEventsResult.size(); i++)
-		{
-			LPCOLLISIONEVENT e = coEventsResult[i];
-			if (dynamic_cast<CBrick*>(e->obj))
-			{
-				CBrick* brick = dynamic_cast<CBrick*>(e->obj);
-				float bleft, btop, bright, bbottom;
-				GetBoundingBox(bleft, btop, bright, bbottom);
-				float oleft, otop, obottom, oright;
-				e->obj->GetBoundingBox(oleft, otop, oright, obottom);
-				if (e->nx != 0)
-				{
-					if (brick->GetType() != BRICK_TYPE_BIG_BLOCK)
-					{
-						//this->vx = 0;
-						this->x = x0 + min_tx * this->dx + e->nx * 0.1f;
-						SetState(BULLET_STATE_EXPLODING);
-					}
-
-				}
-				else if (e->ny != 0)
-				{
-					this->y = y0 + min_ty * this->dy + e->ny * 0.1f;
-					this->vy = -BULLET_MARIO_DEFLECT_SPEED;
-				}
-			}
-			else if(dynamic_cast<CGoomba*>(e->obj))
-			{
-				CGoomba* goomba = dynamic_cast<CGoomba*>(e->obj);
-				goomba->SetState(GOOMBA_STATE_DIE_X);
-				this->SetState(BULLET_STATE_EXPLODING);
-			}
-			else if(dynamic_cast<CMario*>(e->obj))
-			{
-				CMario* mario = dynamic_cast<CMario*>(e->obj);
-				mario->BeDamaged();
-			}
-
-		}
+			RespondToCollision(coEventsResult[i], c);
 
 	}
 
-	// clean up collision events
-	for (UINT i = 0; i < coEvents.size(); i++) delete coEvents[i];
 }
 
 
@@ -98,7 +59,7 @@ void CBullet_Mario::SetState(int _state)
 	{
 	case BULLET_STATE_EXPLODING:
 		vx = vy = 0;
-		StartExplode_time =(DWORD) GetTickCount64();
+		StartExplode_time =(DWORD) CGame::GetInstance()->GetSceneTime();
 		break;
 	}
 }
@@ -107,3 +68,46 @@ CBullet_Mario::~CBullet_Mario()
 
 }
 
+void CBullet_Mario::RegisterCollisionResponses()
+{
+	SetCollisionResponse(OBJECT_KIND_BULLET_MARIO, OBJECT_KIND_BRICK, (LPCOLLISIONRESPONSE)&CBullet_Mario::OnCollisionWithBrick);
+	SetCollisionResponse(OBJECT_KIND_BULLET_MARIO, OBJECT_KIND_GOOMBA, (LPCOLLISIONRESPONSE)&CBullet_Mario::OnCollisionWithGoomba);
+	SetCollisionResponse(OBJECT_KIND_BULLET_MARIO, OBJECT_KIND_MARIO, (LPCOLLISIONRESPONSE)&CBullet_Mario::OnCollisionWithMario);
+}
+
+void CBullet_Mario::OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CBrick* brick = (CBrick*)e->obj;
+	float bleft, btop, bright, bbottom;
+	GetBoundingBox(bleft, btop, bright, bbottom);
+	float oleft, otop, obottom, oright;
+	e->obj->GetCachedBoundingBox(oleft, otop, oright, obottom);
+	if (e->nx != 0)
+	{
+		if (brick->GetType() != BRICK_TYPE_BIG_BLOCK)
+		{
+			//this->vx = 0;
+			this->x = c.x0 + c.min_tx * this->dx + e->nx * 0.1f;
+			SetState(BULLET_STATE_EXPLODING);
+		}
+
+	}
+	else if (e->ny != 0)
+	{
+		this->y = c.y0 + c.min_ty * this->dy + e->ny * 0.1f;
+		this->vy = -BULLET_MARIO_DEFLECT_SPEED;
+	}
+}
+
+void CBullet_Mario::OnCollisionWithGoomba(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CGoomba* goomba = (CGoomba*)e->obj;
+	goomba->SetState(GOOMBA_STATE_DIE_X);
+	this->SetState(BULLET_STATE_EXPLODING);
+}
+
+void CBullet_Mario::OnCollisionWithMario(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CMario* mario = (CMario*)e->obj;
+	mario->BeDamaged();
+}
@@ -21,4 +21,9 @@ public:
 	CBullet_Mario(float x, float y);
 	virtual ~CBullet_Mario();
 	DWORD GetStartExplode_time() { return StartExplode_time; }
+
+	static void RegisterCollisionResponses();
+	void OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithGoomba(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithMario(LPCOLLISIONEVENT e, CCollisionContext& c);
 };
\ No newline at end of file
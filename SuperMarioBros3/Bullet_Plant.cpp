@@ -20,9 +20,9 @@ void CBullet_Plant::Calculate_vxvy(int angle)
 void CBullet_Plant::CalcPotentialCollisionWithMario()
 {
 	CMario* mario = ((CPlayScene*)CGame::GetInstance()->GetCurrentScene())->GetPlayer();
-	LPCOLLISIONEVENT e = SweptAABBEx(mario);
+	CCollisionEvent e = SweptAABBEx(mario);
 
-	if (e->t > 0 && e->t <= 1.0f)
+	if (e.t > 0 && e.t <= 1.0f)
 	{
 		if (!mario->IsUntouchable() )
 		{ 
@@ -11,5 +11,5 @@ void CBush::Render()
 }
 void CBush::GetBoundingBox(float& left, float& top, float& right, float& bottom)
 {
-
+	left = top = right = bottom = 0;
 }
\ No newline at end of file
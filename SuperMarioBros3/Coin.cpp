@@ -48,9 +48,10 @@ void CCoin::CalcPotentialCollisionWithMario()
 {
 	CMario* mario = ((CPlayScene*)CGame::GetInstance()->GetCurrentScene())->GetPlayer();
 	float ml, mt, mr, mb;
-	mario->GetBoundingBox(ml, mt, mr, mb);
+	mario->GetCachedBoundingBox(ml, mt, mr, mb);
 	float cl, ct, cr, cb;
-	GetBoundingBox(cl, ct, cr, cb);
+	RefreshBoundingBox();
+	GetCachedBoundingBox(cl, ct, cr, cb);
 
 	if (cb<mt || ct>mb || ml > cr || mr < cl)
 		return;
@@ -0,0 +1,209 @@
+#include "D3D9Renderer.h"
+#include "Utils.h"
+
+CD3D9Texture::~CD3D9Texture()
+{
+	if (texture != NULL) texture->Release();
+}
+
+/*
+	Initialize DirectX, create a Direct3D device for rendering within the window, initial Sprite library for
+	rendering 2D images
+	- hWnd: Application window handle
+	- width, height: back buffer size
+*/
+bool CD3D9Renderer::Init(HWND hWnd, int width, int height)
+{
+	d3d = Direct3DCreate9(D3D_SDK_VERSION);
+
+	D3DPRESENT_PARAMETERS d3dpp;
+
+	ZeroMemory(&d3dpp, sizeof(d3dpp));
+
+	d3dpp.Windowed = TRUE;
+	d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	d3dpp.BackBufferFormat = D3DFMT_X8R8G8B8;
+	d3dpp.BackBufferCount = 1;
+
+	d3dpp.BackBufferHeight = height;
+	d3dpp.BackBufferWidth = width;
+
+	d3d->CreateDevice(
+		D3DADAPTER_DEFAULT,
+		D3DDEVTYPE_HAL,
+		hWnd,
+		D3DCREATE_SOFTWARE_VERTEXPROCESSING,
+		&d3dpp,
+		&d3ddv);
+
+	if (d3ddv == NULL)
+	{
+		OutputDebugString(L"[ERROR] CreateDevice failed\n");
+		return false;
+	}
+
+	d3ddv->GetBackBuffer(0, 0, D3DBACKBUFFER_TYPE_MONO, &backBuffer);
+
+	// Initialize sprite helper from Direct3DX helper library
+	D3DXCreateSprite(d3ddv, &spriteHandler);
+
+	return true;
+}
+
+LPTEXTURE CD3D9Renderer::LoadTexture(LPCWSTR filePath, COLOR transparentColor)
+{
+	D3DXIMAGE_INFO info;
+	HRESULT result = D3DXGetImageInfoFromFile(filePath, &info);
+	if (result != D3D_OK)
+	{
+		DebugOut(L"[ERROR] GetImageInfoFromFile failed: %s\n", filePath);
+		return NULL;
+	}
+
+	LPDIRECT3DTEXTURE9 texture;
+
+	result = D3DXCreateTextureFromFileEx(
+		d3ddv,								// Pointer to Direct3D device object
+		filePath,							// Path to the image to load
+		info.Width,							// Texture width
+		info.Height,						// Texture height
+		1,
+		D3DUSAGE_DYNAMIC,
+		D3DFMT_UNKNOWN,
+		D3DPOOL_DEFAULT,
+		D3DX_DEFAULT,
+		D3DX_DEFAULT,
+		transparentColor,
+		&info,
+		NULL,
+		&texture);								// Created texture pointer
+
+	if (result != D3D_OK)
+	{
+		OutputDebugString(L"[ERROR] CreateTextureFromFile failed\n");
+		return NULL;
+	}
+
+	CD3D9Texture* t = new CD3D9Texture();
+	t->texture = texture;
+	t->width = info.Width;
+	t->height = info.Height;
+	return t;
+}
+
+LPTEXTURE CD3D9Renderer::CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies)
+{
+	LPDIRECT3DTEXTURE9 atlas;
+	if (FAILED(d3ddv->CreateTexture(width, height, 1, D3DUSAGE_DYNAMIC, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, &atlas, NULL)))
+	{
+		OutputDebugString(L"[ERROR] CreateTexture of an atlas failed\n");
+		return NULL;
+	}
+
+	CD3D9Texture* t = new CD3D9Texture();
+	t->texture = atlas;
+	t->width = width;
+	t->height = height;
+	if (!UpdateAtlas(t, 0, 0, width, height, copies))
+	{
+		delete t;
+		return NULL;
+	}
+	return t;
+}
+
+/*
+	The textures are loaded dynamic, their pixels can be locked and copied. Only 32 bit
+	ARGB sheets are copied, which is what D3DX makes of an image with a color key
+*/
+bool CD3D9Renderer::UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies)
+{
+	LPDIRECT3DTEXTURE9 target = ((CD3D9Texture*)atlas)->texture;
+	bool whole = left == 0 && top == 0 && right == atlas->width && bottom == atlas->height;
+
+	RECT area = { left, top, right, bottom };
+	D3DLOCKED_RECT dst;
+	if (FAILED(target->LockRect(0, &dst, whole ? NULL : &area, whole ? D3DLOCK_DISCARD : 0)))
+		return false;
+	for (int y = 0; y < bottom - top; y++)
+		memset((BYTE*)dst.pBits + y * dst.Pitch, 0, (right - left) * 4);
+
+	bool copied = true;
+	for (size_t i = 0; i < copies.size() && copied; i++)
+	{
+		const CAtlasCopy& c = copies[i];
+		LPDIRECT3DTEXTURE9 source = ((CD3D9Texture*)c.source)->texture;
+
+		D3DSURFACE_DESC desc;
+		source->GetLevelDesc(0, &desc);
+		if (desc.Format != D3DFMT_A8R8G8B8)
+		{
+			copied = false;
+			break;
+		}
+
+		RECT r = { c.left, c.top, c.right, c.bottom };
+		D3DLOCKED_RECT src;
+		if (FAILED(source->LockRect(0, &src, &r, D3DLOCK_READONLY)))
+		{
+			copied = false;
+			break;
+		}
+		for (int row = 0; row < c.bottom - c.top; row++)
+			memcpy((BYTE*)dst.pBits + (c.y - top + row) * dst.Pitch + (c.x - left) * 4,
+				(BYTE*)src.pBits + row * src.Pitch, (c.right - c.left) * 4);
+		source->UnlockRect(0);
+	}
+	target->UnlockRect(0);
+	return copied;
+}
+
+void CD3D9Renderer::BeginFrame(COLOR background)
+{
+	inScene = SUCCEEDED(d3ddv->BeginScene());
+	if (!inScene)
+		return;
+
+	// Clear back buffer with a color
+	d3ddv->ColorFill(backBuffer, NULL, background);
+
+	spriteHandler->Begin(D3DXSPRITE_ALPHABLEND);
+}
+
+/*
+	Utility function to wrap LPD3DXSPRITE::Draw
+*/
+void CD3D9Renderer::Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha)
+{
+	if (!inScene)
+		return;
+
+	D3DXVECTOR3 p(x, y, 0);
+	RECT r;
+	r.left = left;
+	r.top = top;
+	r.right = right;
+	r.bottom = bottom;
+	spriteHandler->Draw(((CD3D9Texture*)texture)->texture, &r, NULL, &p, D3DCOLOR_ARGB(alpha, 255, 255, 255));
+}
+
+void CD3D9Renderer::EndFrame()
+{
+	if (inScene)
+	{
+		spriteHandler->End();
+		d3ddv->EndScene();
+		inScene = false;
+	}
+
+	// Display back buffer content to the screen
+	d3ddv->Present(NULL, NULL, NULL, NULL);
+}
+
+CD3D9Renderer::~CD3D9Renderer()
+{
+	if (spriteHandler != NULL) spriteHandler->Release();
+	if (backBuffer != NULL) backBuffer->Release();
+	if (d3ddv != NULL) d3ddv->Release();
+	if (d3d != NULL) d3d->Release();
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <d3d9.h>
+#include <d3dx9.h>
+
+#include "Renderer.h"
+
+class CD3D9Texture : public CTexture
+{
+public:
+	LPDIRECT3DTEXTURE9 texture = NULL;
+
+	~CD3D9Texture();
+};
+
+/*
+	Draws with Direct3D 9 and the D3DX sprite helper
+*/
+class CD3D9Renderer : public CRenderer
+{
+	LPDIRECT3D9 d3d = NULL;						// Direct3D handle
+	LPDIRECT3DDEVICE9 d3ddv = NULL;				// Direct3D device object
+
+	LPDIRECT3DSURFACE9 backBuffer = NULL;
+	LPD3DXSPRITE spriteHandler = NULL;			// Sprite helper library to help us draw 2D image on the screen
+
+	bool inScene = false;
+
+public:
+	bool Init(HWND hWnd, int width, int height);
+
+	LPTEXTURE LoadTexture(LPCWSTR filePath, COLOR transparentColor);
+	LPTEXTURE CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies);
+	bool UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies);
+
+	void BeginFrame(COLOR background);
+	void Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha);
+	void EndFrame();
+
+	~CD3D9Renderer();
+};
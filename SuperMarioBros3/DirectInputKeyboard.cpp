@@ -0,0 +1,121 @@
+#include "DirectInputKeyboard.h"
+#include "Utils.h"
+
+bool CDirectInputKeyboard::Init(HWND hWnd)
+{
+	HRESULT
+		hr = DirectInput8Create
+		(
+			(HINSTANCE)GetWindowLong(hWnd, GWL_HINSTANCE),
+			DIRECTINPUT_VERSION,
+			IID_IDirectInput8, (VOID**)&di, NULL
+		);
+
+	if (hr != DI_OK)
+	{
+		DebugOut(L"[ERROR] DirectInput8Create failed!\n");
+		return false;
+	}
+
+	hr = di->CreateDevice(GUID_SysKeyboard, &didv, NULL);
+
+	// TO-DO: put in exception handling
+	if (hr != DI_OK)
+	{
+		DebugOut(L"[ERROR] CreateDevice failed!\n");
+		return false;
+	}
+
+	// Set the data format to "keyboard format" - a predefined data format
+	//
+	// A data format specifies which controls on a device we
+	// are interested in, and how they should be reported.
+	//
+	// This tells DirectInput that we will be passing an array
+	// of 256 bytes to IDirectInputDevice::GetDeviceState.
+
+	hr = didv->SetDataFormat(&c_dfDIKeyboard);
+
+	hr = didv->SetCooperativeLevel(hWnd, DISCL_FOREGROUND | DISCL_NONEXCLUSIVE);
+
+
+	// IMPORTANT STEP TO USE BUFFERED DEVICE DATA!
+	//
+	// DirectInput uses unbuffered I/O (buffer size = 0) by default.
+	// If you want to read buffered data, you need to set a nonzero
+	// buffer size.
+	//
+	// Set the buffer size to DINPUT_BUFFERSIZE (defined above) elements.
+	//
+	// The buffer size is a DWORD property associated with the device.
+	DIPROPDWORD dipdw;
+
+	dipdw.diph.dwSize = sizeof(DIPROPDWORD);
+	dipdw.diph.dwHeaderSize = sizeof(DIPROPHEADER);
+	dipdw.diph.dwObj = 0;
+	dipdw.diph.dwHow = DIPH_DEVICE;
+	dipdw.dwData = DIRECTINPUT_BUFFER_SIZE; // Arbitary buffer size
+
+	hr = didv->SetProperty(DIPROP_BUFFERSIZE, &dipdw.diph);
+
+	hr = didv->Acquire();
+	if (hr != DI_OK)
+	{
+		DebugOut(L"[ERROR] DINPUT8::Acquire failed!\n");
+		return false;
+	}
+
+	return true;
+}
+
+bool CDirectInputKeyboard::GetKeyStates(BYTE states[256])
+{
+	HRESULT hr = didv->GetDeviceState(256, states);
+	if (FAILED(hr))
+	{
+		// If the keyboard lost focus or was not acquired then try to get control back.
+		if ((hr == DIERR_INPUTLOST) || (hr == DIERR_NOTACQUIRED))
+		{
+			HRESULT h = didv->Acquire();
+			if (h==DI_OK)
+			{
+				DebugOut(L"[INFO] Keyboard re-acquired!\n");
+			}
+			else return false;
+		}
+		else
+		{
+			//DebugOut(L"[ERROR] DINPUT::GetDeviceState failed. Error: %d\n", hr);
+			return false;
+		}
+	}
+	return true;
+}
+
+int CDirectInputKeyboard::GetKeyEvents(CKeyEvent* events, int maxEvents)
+{
+	DWORD dwElements = min(maxEvents, DIRECTINPUT_BUFFER_SIZE);
+	HRESULT hr = didv->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), keyEvents, &dwElements, 0);
+	if (FAILED(hr))
+	{
+		//DebugOut(L"[ERROR] DINPUT::GetDeviceData failed. Error: %d\n", hr);
+		return 0;
+	}
+
+	for (DWORD i = 0; i < dwElements; i++)
+	{
+		events[i].keyCode = keyEvents[i].dwOfs;
+		events[i].down = (keyEvents[i].dwData & 0x80) > 0;
+	}
+	return (int)dwElements;
+}
+
+CDirectInputKeyboard::~CDirectInputKeyboard()
+{
+	if (didv != NULL)
+	{
+		didv->Unacquire();
+		didv->Release();
+	}
+	if (di != NULL) di->Release();
+}
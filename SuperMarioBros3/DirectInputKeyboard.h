@@ -0,0 +1,27 @@
+#pragma once
+
+#define DIRECTINPUT_VERSION 0x0800
+#include <dinput.h>
+
+#include "Input.h"
+
+#define DIRECTINPUT_BUFFER_SIZE 1024
+
+/*
+	Keyboard read through DirectInput 8, with its buffered events
+*/
+class CDirectInputKeyboard : public CInput
+{
+	LPDIRECTINPUT8       di = NULL;		// The DirectInput object
+	LPDIRECTINPUTDEVICE8 didv = NULL;		// The keyboard device
+
+	DIDEVICEOBJECTDATA keyEvents[DIRECTINPUT_BUFFER_SIZE];		// Buffered keyboard data
+
+public:
+	bool Init(HWND hWnd);
+
+	bool GetKeyStates(BYTE states[256]);
+	int GetKeyEvents(CKeyEvent* events, int maxEvents);
+
+	~CDirectInputKeyboard();
+};
@@ -1,4 +1,5 @@
 #include "EndSceneNotification.h"
+#include "Snapshot.h"
 
 
 
@@ -30,5 +31,28 @@ void CEndSceneNotification::Render()
 }
 void CEndSceneNotification::GetBoundingBox(float& left, float& top, float& right, float& bottom)
 {
+	left = top = right = bottom = 0;
+}
 
-}
\ No newline at end of file
+void CEndSceneNotification::SaveContainers(CSnapshot& s)
+{
+	CGameObject::SaveContainers(s);
+	s.WriteVector(course);
+	s.WriteVector(clear);
+}
+
+void CEndSceneNotification::ReleaseContainers()
+{
+	CGameObject::ReleaseContainers();
+	vector<LPSPRITE>().swap(course);
+	vector<LPSPRITE>().swap(clear);
+}
+
+void CEndSceneNotification::LoadContainers(CSnapshot& s)
+{
+	CGameObject::LoadContainers(s);
+	new (&course) vector<LPSPRITE>();
+	new (&clear) vector<LPSPRITE>();
+	s.ReadVector(course);
+	s.ReadVector(clear);
+}
@@ -11,5 +11,8 @@ public:
 	virtual void Update(DWORD dt, vector<LPGAMEOBJECT>* colliable_objects = NULL);
 	virtual void Render();
 	virtual void GetBoundingBox(float& left, float& top, float& right, float& bottom);
+	virtual void SaveContainers(CSnapshot& s);
+	virtual void ReleaseContainers();
+	virtual void LoadContainers(CSnapshot& s);
 };
 
@@ -1,6 +1,8 @@
 #pragma once
 #include "Sprites.h"
 #include <map>
+#include <vector>
+#include <string>
 using namespace std;
 
 #define FONT_SPRITE_0	999101
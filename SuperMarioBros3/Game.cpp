@@ -1,11 +1,16 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SWEPT_AABB_SSE
+#endif
 #include "Game.h"
 #include "Utils.h"
 #include "HUD.h"
 
 #include "PlayScence.h"
+#include "World.h"
 #include "IntroScene.h"
 #include "WorldMap.h"
 #include "Font.h"
@@ -16,72 +21,34 @@
 #define TYPE_WORLD_MAP		2
 #define TYPE_PLAY_SCENE		3
 
-CGame * CGame::__instance = NULL;
-
 /*
-	Initialize DirectX, create a Direct3D device for rendering within the window, initial Sprite library for 
-	rendering 2D images
-	- hInst: Application instance handle
+	Initialize the renderer for the window and take the keyboard backend, CGame owns both
 	- hWnd: Application window handle
 */
-void CGame::Init(HWND hWnd)
+void CGame::Init(HWND hWnd, LPRENDERER renderer, LPINPUT input)
 {
-	LPDIRECT3D9 d3d = Direct3DCreate9(D3D_SDK_VERSION);
-
-	this->hWnd = hWnd;									
-
-	D3DPRESENT_PARAMETERS d3dpp;
-
-	ZeroMemory(&d3dpp, sizeof(d3dpp));
-
-	d3dpp.Windowed = TRUE;
-	d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
-	d3dpp.BackBufferFormat = D3DFMT_X8R8G8B8;
-	d3dpp.BackBufferCount = 1;
+	this->hWnd = hWnd;
+	this->renderer = renderer;
+	this->input = input;
 
 	RECT r;
 	GetClientRect(hWnd, &r);	// retrieve Window width & height 
 
-	d3dpp.BackBufferHeight = r.bottom + 1;
-	d3dpp.BackBufferWidth = r.right + 1;
-
 	screen_height = r.bottom + 1;
 	screen_width = r.right + 1;
 
-	d3d->CreateDevice(
-		D3DADAPTER_DEFAULT,
-		D3DDEVTYPE_HAL,
-		hWnd,
-		D3DCREATE_SOFTWARE_VERTEXPROCESSING,
-		&d3dpp,
-		&d3ddv);
-
-	if (d3ddv == NULL)
-	{
-		OutputDebugString(L"[ERROR] CreateDevice failed\n");
+	if (!renderer->Init(hWnd, screen_width, screen_height))
 		return;
-	}
-
-	d3ddv->GetBackBuffer(0, 0, D3DBACKBUFFER_TYPE_MONO, &backBuffer);
-
-	// Initialize sprite helper from Direct3DX helper library
-	D3DXCreateSprite(d3ddv, &spriteHandler);
 
 	OutputDebugString(L"[INFO] InitGame done;\n");
 }
 
 /*
-	Utility function to wrap LPD3DXSPRITE::Draw 
+	Draw part of a texture at a position in the world
 */
-void CGame::Draw(float x, float y, LPDIRECT3DTEXTURE9 texture, int left, int top, int right, int bottom, int alpha)
+void CGame::Draw(float x, float y, LPTEXTURE texture, int left, int top, int right, int bottom, int alpha)
 {
-	D3DXVECTOR3 p(round(x - cam_x), round(y - cam_y), 0);
-	RECT r; 
-	r.left = left;
-	r.top = top;
-	r.right = right;
-	r.bottom = bottom;
-	spriteHandler->Draw(texture, &r, NULL, &p, D3DCOLOR_ARGB(alpha, 255, 255, 255));
+	renderer->Draw(texture, round(x - cam_x), round(y - cam_y), left, top, right, bottom, alpha);
 }
 
 int CGame::IsKeyDown(int KeyCode)
@@ -91,127 +58,41 @@ int CGame::IsKeyDown(int KeyCode)
 
 void CGame::InitKeyboard()
 {
-	HRESULT
-		hr = DirectInput8Create
-		(
-			(HINSTANCE)GetWindowLong(hWnd, GWL_HINSTANCE),
-			DIRECTINPUT_VERSION,
-			IID_IDirectInput8, (VOID**)&di, NULL
-		);
-
-	if (hr != DI_OK)
-	{
-		DebugOut(L"[ERROR] DirectInput8Create failed!\n");
-		return;
-	}
-
-	hr = di->CreateDevice(GUID_SysKeyboard, &didv, NULL);
-
-	// TO-DO: put in exception handling
-	if (hr != DI_OK) 
-	{
-		DebugOut(L"[ERROR] CreateDevice failed!\n");
-		return;
-	}
-
-	// Set the data format to "keyboard format" - a predefined data format 
-	//
-	// A data format specifies which controls on a device we
-	// are interested in, and how they should be reported.
-	//
-	// This tells DirectInput that we will be passing an array
-	// of 256 bytes to IDirectInputDevice::GetDeviceState.
-
-	hr = didv->SetDataFormat(&c_dfDIKeyboard);
-
-	hr = didv->SetCooperativeLevel(hWnd, DISCL_FOREGROUND | DISCL_NONEXCLUSIVE);
-
-
-	// IMPORTANT STEP TO USE BUFFERED DEVICE DATA!
-	//
-	// DirectInput uses unbuffered I/O (buffer size = 0) by default.
-	// If you want to read buffered data, you need to set a nonzero
-	// buffer size.
-	//
-	// Set the buffer size to DINPUT_BUFFERSIZE (defined above) elements.
-	//
-	// The buffer size is a DWORD property associated with the device.
-	DIPROPDWORD dipdw;
-
-	dipdw.diph.dwSize = sizeof(DIPROPDWORD);
-	dipdw.diph.dwHeaderSize = sizeof(DIPROPHEADER);
-	dipdw.diph.dwObj = 0;
-	dipdw.diph.dwHow = DIPH_DEVICE;
-	dipdw.dwData = KEYBOARD_BUFFER_SIZE; // Arbitary buffer size
-
-	hr = didv->SetProperty(DIPROP_BUFFERSIZE, &dipdw.diph);
-
-	hr = didv->Acquire();
-	if (hr != DI_OK)
-	{
-		DebugOut(L"[ERROR] DINPUT8::Acquire failed!\n");
+	if (!input->Init(hWnd))
 		return;
-	}
 
 	DebugOut(L"[INFO] Keyboard has been initialized successfully\n");
 }
 
 void CGame::ProcessKeyboard()
 {
-	HRESULT hr; 
-
 	// Collect all key states first
-	hr = didv->GetDeviceState(sizeof(keyStates), keyStates);
-	if (FAILED(hr))
-	{
-		// If the keyboard lost focus or was not acquired then try to get control back.
-		if ((hr == DIERR_INPUTLOST) || (hr == DIERR_NOTACQUIRED))
-		{
-			HRESULT h = didv->Acquire();
-			if (h==DI_OK)
-			{ 
-				DebugOut(L"[INFO] Keyboard re-acquired!\n");
-			}
-			else return;
-		}
-		else
-		{
-			//DebugOut(L"[ERROR] DINPUT::GetDeviceState failed. Error: %d\n", hr);
-			return;
-		}
-	}
+	if (!input->GetKeyStates(keyStates))
+		return;
 
 	keyHandler->KeyState((BYTE *)&keyStates);
 
 
 
 	// Collect all buffered events
-	DWORD dwElements = KEYBOARD_BUFFER_SIZE;
-	hr = didv->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), keyEvents, &dwElements, 0);
-	if (FAILED(hr))
-	{
-		//DebugOut(L"[ERROR] DINPUT::GetDeviceData failed. Error: %d\n", hr);
-		return;
-	}
+	int n = input->GetKeyEvents(keyEvents, KEYBOARD_BUFFER_SIZE);
 
 	// Scan through all buffered events, check if the key is pressed or released
-	for (DWORD i = 0; i < dwElements; i++)
+	for (int i = 0; i < n; i++)
 	{
-		int KeyCode = keyEvents[i].dwOfs;
-		int KeyState = keyEvents[i].dwData;
-		if ((KeyState & 0x80) > 0)
-			keyHandler->OnKeyDown(KeyCode);
+		if (keyEvents[i].down)
+			keyHandler->OnKeyDown(keyEvents[i].keyCode);
 		else
-			keyHandler->OnKeyUp(KeyCode);
+			keyHandler->OnKeyUp(keyEvents[i].keyCode);
 	}
 }
 
 CGame::~CGame()
 {
-	if (spriteHandler != NULL) spriteHandler->Release();
-	if (backBuffer != NULL) backBuffer->Release();
-	if (d3ddv != NULL) d3ddv->Release();
-	if (d3d != NULL) d3d->Release();
+	for (auto& s : scenes)
+		delete s.second;
+	delete input;
+	delete renderer;
 }
 
 /*
@@ -316,10 +197,125 @@ void CGame::SweptAABB(
 
 }
 
+/*
+	SweptAABB of one moving object against n objects at once, 4 pairs per step with SSE.
+	Static objects are given as separate arrays (l, t, r, b, vx, vy), the speeds are
+	turned into relative distances the same way CGameObject::SweptAABBEx does.
+
+	Every lane follows the scalar SweptAABB operation by operation, so the results are
+	bit-exact with it; debug builds check that.
+*/
+void CGame::SweptAABBBatch(
+	float ml, float mt, float mr, float mb,
+	float dx, float dy, DWORD dt,
+	int n,
+	const float* sl, const float* st, const float* sr, const float* sb,
+	const float* svx, const float* svy,
+	float* t, float* nx, float* ny, float* rdx, float* rdy)
+{
+	int i = 0;
+
+#ifdef SWEPT_AABB_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minus_one = _mm_set1_ps(-1.0f);
+	const __m128 all_bits = _mm_cmpeq_ps(zero, zero);
+	const __m128 x_infinity = _mm_set1_ps(999999.0f);
+	const __m128 y_infinity = _mm_set1_ps(99999.0f);
+
+	const __m128 v_ml = _mm_set1_ps(ml);
+	const __m128 v_mt = _mm_set1_ps(mt);
+	const __m128 v_mr = _mm_set1_ps(mr);
+	const __m128 v_mb = _mm_set1_ps(mb);
+	const __m128 v_dx = _mm_set1_ps(dx);
+	const __m128 v_dy = _mm_set1_ps(dy);
+	const __m128 v_dt = _mm_set1_ps((float)dt);
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 v_sl = _mm_loadu_ps(sl + i);
+		__m128 v_st = _mm_loadu_ps(st + i);
+		__m128 v_sr = _mm_loadu_ps(sr + i);
+		__m128 v_sb = _mm_loadu_ps(sb + i);
+
+		__m128 v_rdx = _mm_sub_ps(v_dx, _mm_mul_ps(_mm_loadu_ps(svx + i), v_dt));
+		__m128 v_rdy = _mm_sub_ps(v_dy, _mm_mul_ps(_mm_loadu_ps(svy + i), v_dt));
+
+		__m128 x_pos = _mm_cmpgt_ps(v_rdx, zero);
+		__m128 y_pos = _mm_cmpgt_ps(v_rdy, zero);
+		__m128 x_still = _mm_cmpeq_ps(v_rdx, zero);
+		__m128 y_still = _mm_cmpeq_ps(v_rdy, zero);
+
+		// broad-phase test
+		__m128 bl = _mm_or_ps(_mm_and_ps(x_pos, v_ml), _mm_andnot_ps(x_pos, _mm_add_ps(v_ml, v_rdx)));
+		__m128 bt = _mm_or_ps(_mm_and_ps(y_pos, v_mt), _mm_andnot_ps(y_pos, _mm_add_ps(v_mt, v_rdy)));
+		__m128 br = _mm_or_ps(_mm_and_ps(x_pos, _mm_add_ps(v_mr, v_rdx)), _mm_andnot_ps(x_pos, v_mr));
+		__m128 bb = _mm_or_ps(_mm_and_ps(y_pos, _mm_add_ps(v_mb, v_rdy)), _mm_andnot_ps(y_pos, v_mb));
+
+		__m128 miss = _mm_or_ps(
+			_mm_or_ps(_mm_cmplt_ps(br, v_sl), _mm_cmpgt_ps(bl, v_sr)),
+			_mm_or_ps(_mm_cmplt_ps(bb, v_st), _mm_cmpgt_ps(bt, v_sb)));
+		miss = _mm_or_ps(miss, _mm_and_ps(x_still, y_still));
+
+		__m128 dx_entry = _mm_or_ps(_mm_and_ps(x_pos, _mm_sub_ps(v_sl, v_mr)), _mm_andnot_ps(x_pos, _mm_sub_ps(v_sr, v_ml)));
+		__m128 dx_exit = _mm_or_ps(_mm_and_ps(x_pos, _mm_sub_ps(v_sr, v_ml)), _mm_andnot_ps(x_pos, _mm_sub_ps(v_sl, v_mr)));
+		__m128 dy_entry = _mm_or_ps(_mm_and_ps(y_pos, _mm_sub_ps(v_st, v_mb)), _mm_andnot_ps(y_pos, _mm_sub_ps(v_sb, v_mt)));
+		__m128 dy_exit = _mm_or_ps(_mm_and_ps(y_pos, _mm_sub_ps(v_sb, v_mt)), _mm_andnot_ps(y_pos, _mm_sub_ps(v_st, v_mb)));
+
+		// lanes that do not move on an axis divide by zero here, the result is thrown away
+		__m128 tx_entry = _mm_or_ps(_mm_and_ps(x_still, _mm_set1_ps(-999999.0f)), _mm_andnot_ps(x_still, _mm_div_ps(dx_entry, v_rdx)));
+		__m128 tx_exit = _mm_or_ps(_mm_and_ps(x_still, x_infinity), _mm_andnot_ps(x_still, _mm_div_ps(dx_exit, v_rdx)));
+		__m128 ty_entry = _mm_or_ps(_mm_and_ps(y_still, _mm_set1_ps(-99999.0f)), _mm_andnot_ps(y_still, _mm_div_ps(dy_entry, v_rdy)));
+		__m128 ty_exit = _mm_or_ps(_mm_and_ps(y_still, y_infinity), _mm_andnot_ps(y_still, _mm_div_ps(dy_exit, v_rdy)));
+
+		miss = _mm_or_ps(miss, _mm_and_ps(_mm_cmplt_ps(tx_entry, zero), _mm_cmplt_ps(ty_entry, zero)));
+		miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(tx_entry, one), _mm_cmpgt_ps(ty_entry, one)));
+
+		// same operand order as the max/min macros
+		__m128 t_entry = _mm_max_ps(tx_entry, ty_entry);
+		__m128 t_exit = _mm_min_ps(tx_exit, ty_exit);
+		miss = _mm_or_ps(miss, _mm_cmpgt_ps(t_entry, t_exit));
+
+		__m128 x_first = _mm_cmpgt_ps(tx_entry, ty_entry);
+		__m128 x_side = _mm_andnot_ps(miss, x_first);
+		__m128 y_side = _mm_andnot_ps(_mm_or_ps(miss, x_first), all_bits);
+
+		__m128 v_nx = _mm_and_ps(x_side, _mm_or_ps(_mm_and_ps(x_pos, minus_one), _mm_andnot_ps(x_pos, one)));
+		__m128 v_ny = _mm_and_ps(y_side, _mm_or_ps(_mm_and_ps(y_pos, minus_one), _mm_andnot_ps(y_pos, one)));
+
+		_mm_storeu_ps(t + i, _mm_or_ps(_mm_and_ps(miss, minus_one), _mm_andnot_ps(miss, t_entry)));
+		_mm_storeu_ps(nx + i, v_nx);
+		_mm_storeu_ps(ny + i, v_ny);
+		_mm_storeu_ps(rdx + i, v_rdx);
+		_mm_storeu_ps(rdy + i, v_rdy);
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		rdx[i] = dx - svx[i] * dt;
+		rdy[i] = dy - svy[i] * dt;
+		SweptAABB(ml, mt, mr, mb, rdx[i], rdy[i], sl[i], st[i], sr[i], sb[i], t[i], nx[i], ny[i]);
+	}
+
+#ifdef _DEBUG
+	for (i = 0; i < n; i++)
+	{
+		float t0, nx0, ny0;
+		float rdx0 = dx - svx[i] * dt;
+		float rdy0 = dy - svy[i] * dt;
+		SweptAABB(ml, mt, mr, mb, rdx0, rdy0, sl[i], st[i], sr[i], sb[i], t0, nx0, ny0);
+		if (memcmp(&t0, &t[i], sizeof(float)) || memcmp(&nx0, &nx[i], sizeof(float)) || memcmp(&ny0, &ny[i], sizeof(float))
+			|| memcmp(&rdx0, &rdx[i], sizeof(float)) || memcmp(&rdy0, &rdy[i], sizeof(float)))
+			DebugOut(L"[ERROR] SweptAABBBatch differs from SweptAABB at %d: t %f/%f nx %f/%f ny %f/%f\n",
+				i, t[i], t0, nx[i], nx0, ny[i], ny0);
+	}
+#endif
+}
+
 CGame *CGame::GetInstance()
 {
-	if (__instance == NULL) __instance = new CGame();
-	return __instance;
+	return &CWorld::GetCurrent()->game;
 }
 
 #define MAX_GAME_LINE 1024
@@ -375,7 +371,7 @@ void CGame::Load(LPCWSTR gameFile)
 	DebugOut(L"[INFO] Start loading game file : %s\n", gameFile);
 
 	ifstream f;
-	f.open(gameFile);
+	OpenDataFile(f, gameFile);
 	char str[MAX_GAME_LINE];
 
 	// current resource section flag
@@ -420,6 +416,7 @@ void CGame::SwitchScene(int scene_id)
 
 
 	scenes[current_scene]->Unload();
+	scenes[current_scene]->GetTimers()->Clear();
 
 	CPointsEffects::GetInstance()->Clear();
 	CTextures::GetInstance()->Clear();
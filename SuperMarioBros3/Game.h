@@ -1,43 +1,47 @@
 #pragma once
 
 #include <unordered_map>
+#include <string>
 
 #include <Windows.h>
-#include <d3d9.h>
-#include <d3dx9.h>
-
-
-#define DIRECTINPUT_VERSION 0x0800
-#include <dinput.h>
 
+#include "Renderer.h"
+#include "MapChunkCache.h"
+#include "Input.h"
+#include "KeyCodes.h"
 #include "Scence.h"
 
 using namespace std;
 
 #define KEYBOARD_BUFFER_SIZE 1024
 
+// the simulation always advances by whole steps of this many ms, whatever the frame time
+#define SIMULATION_STEP 8
+
+#define RENDER_SNAP_DISTANCE 32.0f		// moved farther than this in one step: teleported, not interpolated
+
 class CGame
 {
-	static CGame * __instance;
 	HWND hWnd;									// Window handle
 
-	LPDIRECT3D9 d3d = NULL;						// Direct3D handle
-	LPDIRECT3DDEVICE9 d3ddv = NULL;				// Direct3D device object
-
-	LPDIRECT3DSURFACE9 backBuffer = NULL;		
-	LPD3DXSPRITE spriteHandler = NULL;			// Sprite helper library to help us draw 2D image on the screen 
+	LPRENDERER renderer = NULL;
+	LPINPUT input = NULL;
 
-	LPDIRECTINPUT8       di;		// The DirectInput object         
-	LPDIRECTINPUTDEVICE8 didv;		// The keyboard device 
-
-	BYTE  keyStates[256];			// DirectInput keyboard state buffer 
-	DIDEVICEOBJECTDATA keyEvents[KEYBOARD_BUFFER_SIZE];		// Buffered keyboard data
+	BYTE  keyStates[256];			// keyboard state buffer 
+	CKeyEvent keyEvents[KEYBOARD_BUFFER_SIZE];		// Buffered keyboard data
 
 	LPKEYEVENTHANDLER keyHandler;
 
 	float cam_x = 0.0f;
 	float cam_y = 0.0f;
 
+	float prev_cam_x = 0.0f;		// camera at the start of the last simulation step
+	float prev_cam_y = 0.0f;
+	float renderAlpha = 1.0f;		// how far the rendered frame is between the last two steps
+	bool packAtlases = true;		// scenes pack their sprites into atlases when they load
+	size_t mapChunkBudget = MAP_CHUNK_CACHE_BUDGET;	// bytes of map chunks kept, 0 draws the maps tile by tile
+	bool hashStates = false;		// play scenes hash their state after every step, see CPlayScene::HashState
+
 	int screen_width;
 	int screen_height; 
 
@@ -50,14 +54,16 @@ class CGame
 public:
 	void InitKeyboard();
 	void SetKeyHandler(LPKEYEVENTHANDLER handler) { keyHandler = handler; }
-	void Init(HWND hWnd);
-	void Draw(float x, float y, LPDIRECT3DTEXTURE9 texture, int left, int top, int right, int bottom, int alpha = 255);
+	void Init(HWND hWnd, LPRENDERER renderer, LPINPUT input);
+	void Draw(float x, float y, LPTEXTURE texture, int left, int top, int right, int bottom, int alpha = 255);
 
 	int IsKeyDown(int KeyCode);
 	void ProcessKeyboard();
 
 	void Load(LPCWSTR gameFile);
 	LPSCENE GetCurrentScene() { return scenes[current_scene]; }
+	int GetCurrentSceneId() { return current_scene; }
+	ULONGLONG GetSceneTime() { return GetCurrentScene()->GetClock(); }
 	void SwitchScene(int scene_id);
 
 	int GetScreenWidth() { return screen_width; }
@@ -78,12 +84,45 @@ public:
 		float &nx, 
 		float &ny);
 
-	LPDIRECT3DDEVICE9 GetDirect3DDevice() { return this->d3ddv; }
-	LPDIRECT3DSURFACE9 GetBackBuffer() { return backBuffer; }
-	LPD3DXSPRITE GetSpriteHandler() { return this->spriteHandler; }
+	static void SweptAABBBatch(
+		float ml,			// move left
+		float mt,			// move top
+		float mr,			// move right
+		float mb,			// move bottom
+		float dx,			// moving object distance in this frame
+		float dy,
+		DWORD dt,
+		int n,				// number of static objects
+		const float* sl,	// static lefts
+		const float* st,
+		const float* sr,
+		const float* sb,
+		const float* svx,	// static speeds
+		const float* svy,
+		float* t,
+		float* nx,
+		float* ny,
+		float* rdx,			// relative distances
+		float* rdy);
+
+	LPRENDERER GetRenderer() { return renderer; }
+	void SetDrawLayer(int layer) { renderer->SetLayer(layer); }
+	void SetPackAtlases(bool pack) { packAtlases = pack; }
+	bool GetPackAtlases() { return packAtlases; }
+	void SetMapChunkBudget(size_t bytes) { mapChunkBudget = bytes; }
+	size_t GetMapChunkBudget() { return mapChunkBudget; }
+	void SetHashStates(bool hash) { hashStates = hash; }
+	bool GetHashStates() { return hashStates; }
+	LPINPUT GetInput() { return input; }
 	void GetCamPos(float& x, float& y) { x = cam_x, y = cam_y; }
 
 	void SetCamPos(float x, float y) { cam_x = x; cam_y = y; }
+	void SaveCamPos() { prev_cam_x = cam_x; prev_cam_y = cam_y; }
+	void GetPrevCamPos(float& x, float& y) { x = prev_cam_x, y = prev_cam_y; }
+	void SetPrevCamPos(float x, float y) { prev_cam_x = x; prev_cam_y = y; }
+
+	void SetRenderAlpha(float alpha) { renderAlpha = alpha; }
+	float GetRenderAlpha() { return renderAlpha; }
 
 	static CGame * GetInstance();
 
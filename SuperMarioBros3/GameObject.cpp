@@ -1,4 +1,3 @@
-#include <d3dx9.h>
 #include <algorithm>
 
 
@@ -10,8 +9,33 @@
 #include "Koopas.h"
 #include "Goomba.h"
 #include "Mario.h"
+#include "Koopa_Small.h"
+#include "Bullet_Mario.h"
 #include "PlayScence.h"
 #include "IntroScene.h"
+#include "ObjectHeap.h"
+#include "Snapshot.h"
+
+LPCOLLISIONRESPONSE CGameObject::collisionResponses[OBJECT_KIND_COUNT][OBJECT_KIND_COUNT];
+
+/*
+	Every object kind that reacts to collisions fills its own row of the table
+*/
+bool CGameObject::InitCollisionResponses()
+{
+	CMario::RegisterCollisionResponses();
+	CKoopa_Small::RegisterCollisionResponses();
+	CGoomba::RegisterCollisionResponses();
+	CBullet_Mario::RegisterCollisionResponses();
+	return true;
+}
+
+static bool collisionResponsesReady = CGameObject::InitCollisionResponses();
+
+void CGameObject::SetCollisionResponse(int selfKind, int otherKind, LPCOLLISIONRESPONSE response)
+{
+	collisionResponses[selfKind][otherKind] = response;
+}
 
 CGameObject::CGameObject()
 {
@@ -23,23 +47,69 @@ CGameObject::CGameObject()
 	animation_set = nullptr;
 }
 
+void* CGameObject::operator new(size_t size)
+{
+	return CObjectHeap::Alloc(size, HEAP_BLOCK_GAME_OBJECT);
+}
+
+void CGameObject::operator delete(void* p)
+{
+	CObjectHeap::Free(p);
+}
+
+// the collision vectors are scratch, cleared by every Update, only their storage matters
+void CGameObject::ReleaseContainers()
+{
+	vector<CCollisionEvent>().swap(coEvents);
+	vector<LPCOLLISIONEVENT>().swap(coEventsResult);
+	vector<LPGAMEOBJECT>().swap(nearby);
+}
+
+void CGameObject::LoadContainers(CSnapshot& s)
+{
+	new (&coEvents) vector<CCollisionEvent>();
+	new (&coEventsResult) vector<LPCOLLISIONEVENT>();
+	new (&nearby) vector<LPGAMEOBJECT>();
+}
+
 void CGameObject::Update(DWORD dt, vector<LPGAMEOBJECT> *coObjects)
 {
 	this->dt = dt;
+	prev_x = x;
+	prev_y = y;
+	hasPrevPosition = true;
 	dx = vx*dt +(ax*dt*dt)/2;
 	dy = vy*dt;
 }
 
+#ifdef _DEBUG
+/*
+	A cached box that differs from GetBoundingBox means a position or state change
+	was not followed by RefreshBoundingBox. Only reported: the box is left as release
+	builds see it, so both simulate the same and the caller gets fixed
+*/
+void CGameObject::CheckCachedBoundingBox()
+{
+	float l, t, r, b;
+	GetBoundingBox(l, t, r, b);
+	if (l != bbox_l || t != bbox_t || r != bbox_r || b != bbox_b)
+	{
+		DebugOut(L"[WARNING] Stale bounding box of kind %d: cached (%f, %f, %f, %f), actual (%f, %f, %f, %f)\n",
+			kind, bbox_l, bbox_t, bbox_r, bbox_b, l, t, r, b);
+	}
+}
+#endif
+
 /*
 	Extension of original SweptAABB to deal with two moving objects
 */
-LPCOLLISIONEVENT CGameObject::SweptAABBEx(LPGAMEOBJECT coO)
+CCollisionEvent CGameObject::SweptAABBEx(LPGAMEOBJECT coO)
 {
 	float sl, st, sr, sb;		// static object bbox
 	float ml, mt, mr, mb;		// moving object bbox
 	float t, nx, ny;
 
-	coO->GetBoundingBox(sl, st, sr, sb);
+	coO->GetCachedBoundingBox(sl, st, sr, sb);
 
 	// deal with moving object: m speed = original m speed - collide object speed
 	float svx, svy;
@@ -52,7 +122,8 @@ LPCOLLISIONEVENT CGameObject::SweptAABBEx(LPGAMEOBJECT coO)
 	float rdx = this->dx - sdx;
 	float rdy = this->dy - sdy;
 
-	GetBoundingBox(ml, mt, mr, mb);
+	RefreshBoundingBox();
+	GetCachedBoundingBox(ml, mt, mr, mb);
 
 	CGame::SweptAABB(
 		ml, mt, mr, mb,
@@ -61,8 +132,104 @@ LPCOLLISIONEVENT CGameObject::SweptAABBEx(LPGAMEOBJECT coO)
 		t, nx, ny
 	);
 
-	CCollisionEvent * e = new CCollisionEvent(t, nx, ny, rdx, rdy, coO);
-	return e;
+	return CCollisionEvent(t, nx, ny, rdx, rdy, coO);
+}
+
+/*
+	Arrays handed to CGame::SweptAABBBatch, kept between calls so they only grow
+*/
+struct CSweptAABBBuffers
+{
+	vector<float> sl, st, sr, sb, svx, svy;
+	vector<float> t, nx, ny, rdx, rdy;
+
+	void Resize(size_t n)
+	{
+		if (t.size() >= n)
+			return;
+		sl.resize(n); st.resize(n); sr.resize(n); sb.resize(n); svx.resize(n); svy.resize(n);
+		t.resize(n); nx.resize(n); ny.resize(n); rdx.resize(n); rdy.resize(n);
+	}
+};
+
+static thread_local CSweptAABBBuffers sweptBuffers;
+
+/*
+	SweptAABBEx against a whole list at once. Boxes and speeds are gathered into
+	separate arrays for CGame::SweptAABBBatch, only the events happening in this
+	frame (0 < t <= 1) are added to coEvents
+*/
+void CGameObject::SweptAABBEx(vector<LPGAMEOBJECT>& coObjects, vector<CCollisionEvent>& coEvents)
+{
+	int n = coObjects.size();
+	if (n == 0)
+		return;
+
+	CSweptAABBBuffers& b = sweptBuffers;
+	b.Resize(n);
+	for (int i = 0; i < n; i++)
+	{
+		coObjects[i]->GetCachedBoundingBox(b.sl[i], b.st[i], b.sr[i], b.sb[i]);
+		coObjects[i]->GetSpeed(b.svx[i], b.svy[i]);
+	}
+
+	float ml, mt, mr, mb;
+	RefreshBoundingBox();
+	GetCachedBoundingBox(ml, mt, mr, mb);
+
+	CGame::SweptAABBBatch(
+		ml, mt, mr, mb,
+		dx, dy, dt, n,
+		&b.sl[0], &b.st[0], &b.sr[0], &b.sb[0], &b.svx[0], &b.svy[0],
+		&b.t[0], &b.nx[0], &b.ny[0], &b.rdx[0], &b.rdy[0]
+	);
+
+	for (int i = 0; i < n; i++)
+	{
+		if (b.t[i] > 0 && b.t[i] <= 1.0f)
+			coEvents.push_back(CCollisionEvent(b.t[i], b.nx[i], b.ny[i], b.rdx[i], b.rdy[i], coObjects[i]));
+	}
+}
+
+/*
+	Broadphase: fills nearby with the objects that may touch the box (l, t, r, b). In a
+	play scene they are queried from the grid, elsewhere coObjects is copied as is
+*/
+void CGameObject::GetNearbyObjects(vector<LPGAMEOBJECT>* coObjects, float l, float t, float r, float b, vector<LPGAMEOBJECT>& nearby)
+{
+	nearby.clear();
+
+	CScene* s = CGame::GetInstance()->GetCurrentScene();
+	CGrid* grid = nullptr;
+	if (dynamic_cast<CPlayScene*>(s))
+		grid = ((CPlayScene*)s)->GetGrid();
+
+	if (grid == nullptr)
+	{
+		if (coObjects != NULL)
+			nearby.insert(nearby.end(), coObjects->begin(), coObjects->end());
+		return;
+	}
+
+	grid->GetCollidables(l, t, r, b, this, nearby);
+
+	// bricks of a map with a collision table are tiles of the map itself
+	Map* map = ((CPlayScene*)s)->GetMap();
+	if (map != nullptr && map->HasCollision())
+		map->GetCollisionTiles(l, t, r, b, nearby);
+}
+
+/*
+	Broadphase over the box swept by this frame's movement
+*/
+void CGameObject::GetNearbyObjects(vector<LPGAMEOBJECT>* coObjects, vector<LPGAMEOBJECT>& nearby)
+{
+	float l, t, r, b;
+	RefreshBoundingBox();
+	GetCachedBoundingBox(l, t, r, b);
+	GetNearbyObjects(coObjects,
+		dx > 0 ? l : l + dx, dy > 0 ? t : t + dy,
+		dx > 0 ? r + dx : r, dy > 0 ? b + dy : b, nearby);
 }
 
 /*
@@ -71,47 +238,53 @@ LPCOLLISIONEVENT CGameObject::SweptAABBEx(LPGAMEOBJECT coO)
 	coObjects: the list of colliable objects
 	coEvents: list of potential collisions
 */
-void CGameObject::CalcPotentialCollisions(vector<LPGAMEOBJECT> *coObjects, vector<LPCOLLISIONEVENT> &coEvents)
+void CGameObject::CalcPotentialCollisions(vector<LPGAMEOBJECT> *coObjects, vector<CCollisionEvent> &coEvents)
 {
-	for (UINT i = 0; i < coObjects->size(); i++)
-	{
-		LPGAMEOBJECT object = coObjects->at(i);
-		CScene* s = CGame::GetInstance()->GetCurrentScene();
-		if(dynamic_cast<CPlayScene*>(s))
-			if (!IsInCamera())
-				continue;
+	CScene* s = CGame::GetInstance()->GetCurrentScene();
+	if (dynamic_cast<CPlayScene*>(s))
+		if (!IsInCamera())
+			return;
 
-		LPCOLLISIONEVENT e = SweptAABBEx(object);
+	// only test the objects around the swept box instead of the whole list
+	GetNearbyObjects(coObjects, nearby);
+
+	UINT first = coEvents.size();
+	SweptAABBEx(nearby, coEvents);
+
+	float mleft, mtop, mright, mbottom;
+	GetCachedBoundingBox(mleft, mtop, mright, mbottom);
+	UINT count = first;
+	for (UINT i = first; i < coEvents.size(); i++)
+	{
+		CCollisionEvent& e = coEvents[i];
 
-		if (e->t > 0 && e->t <= 1.0f)
+		float oleft, otop, obottom, oright;
+		e.obj->GetCachedBoundingBox(oleft, otop, oright, obottom);
+		if (e.nx != 0)
 		{
-			float mleft, mtop, mright, mbottom;
-			GetBoundingBox(mleft, mtop, mright, mbottom);
-			float oleft, otop, obottom, oright;
-			e->obj->GetBoundingBox(oleft, otop, oright, obottom);
-			if (e->nx != 0)
+			if (ceil(mbottom) == otop)
 			{
-				if (ceil(mbottom) == otop)
-				{
-					continue;
-				}
+				continue;
 			}
-			/*else if (e->ny != 0)
-			{
-				if (ceil(mleft) == oright || ceil(mright) == oleft)
-					continue;
-			}*/
-			coEvents.push_back(e);
 		}
-		else
-			delete e;
+		/*else if (e.ny != 0)
+		{
+			if (ceil(mleft) == oright || ceil(mright) == oleft)
+				continue;
+		}*/
+		coEvents[count++] = e;
 	}
+	coEvents.resize(count);
 
 	std::sort(coEvents.begin(), coEvents.end(), CCollisionEvent::compare);
 }
 
+/*
+	Pick the nearest events on each axis. coEventsResult points into coEvents,
+	so it is valid until coEvents is cleared by the next Update
+*/
 void CGameObject::FilterCollision(
-	vector<LPCOLLISIONEVENT> &coEvents,
+	vector<CCollisionEvent> &coEvents,
 	vector<LPCOLLISIONEVENT> &coEventsResult,
 	float &min_tx, float &min_ty, 
 	float &nx, float &ny, float &rdx, float &rdy)
@@ -128,19 +301,19 @@ void CGameObject::FilterCollision(
 
 	for (UINT i = 0; i < coEvents.size(); i++)
 	{
-		LPCOLLISIONEVENT c = coEvents[i];
+		CCollisionEvent& c = coEvents[i];
 		
-		if (c->t < min_tx && c->nx != 0) {
-			min_tx = c->t; nx = c->nx; min_ix = i; rdx = c->dx;
+		if (c.t < min_tx && c.nx != 0) {
+			min_tx = c.t; nx = c.nx; min_ix = i; rdx = c.dx;
 		}
 
-		if (c->t < min_ty  && c->ny > 0) {
-			min_ty = c->t; ny = c->ny; min_iy = i; rdy = c->dy;
+		if (c.t < min_ty  && c.ny > 0) {
+			min_ty = c.t; ny = c.ny; min_iy = i; rdy = c.dy;
 		}
 	}
 
-	if (min_ix>=0) coEventsResult.push_back(coEvents[min_ix]);
-	if (min_iy>=0) coEventsResult.push_back(coEvents[min_iy]);
+	if (min_ix>=0) coEventsResult.push_back(&coEvents[min_ix]);
+	if (min_iy>=0) coEventsResult.push_back(&coEvents[min_iy]);
 
 	float min_ty0 = min_ty;
 	min_ty = 1.0f;
@@ -148,24 +321,44 @@ void CGameObject::FilterCollision(
 
 	for (UINT i = 0; i < coEvents.size(); i++)
 	{
-		LPCOLLISIONEVENT c = coEvents[i];
+		CCollisionEvent& c = coEvents[i];
 
-		if (c->t < min_ty && c->ny < 0) {
-			min_ty = c->t; ny = c->ny; min_iy = i; rdy = c->dy;
+		if (c.t < min_ty && c.ny < 0) {
+			min_ty = c.t; ny = c.ny; min_iy = i; rdy = c.dy;
 		}
 	}
 	if (min_ty == 1.0f)
 		min_ty = min_ty0;
-	if (min_iy >= 0) coEventsResult.push_back(coEvents[min_iy]);
+	if (min_iy >= 0) coEventsResult.push_back(&coEvents[min_iy]);
 }
 
 
+/*
+	Render between the previous and the current simulation step, by the render alpha of
+	the game. Objects that never stepped or just teleported are drawn where they are
+*/
+void CGameObject::RenderInterpolated()
+{
+	if (!hasPrevPosition || abs(x - prev_x) > RENDER_SNAP_DISTANCE || abs(y - prev_y) > RENDER_SNAP_DISTANCE)
+	{
+		Render();
+		return;
+	}
+
+	float alpha = CGame::GetInstance()->GetRenderAlpha();
+	float cur_x = x, cur_y = y;
+	x = prev_x + (cur_x - prev_x) * alpha;
+	y = prev_y + (cur_y - prev_y) * alpha;
+	Render();
+	x = cur_x;
+	y = cur_y;
+}
+
 void CGameObject::RenderBoundingBox()
 {
-	D3DXVECTOR3 p(x, y, 0);
 	RECT rect;
 
-	LPDIRECT3DTEXTURE9 bbox = CTextures::GetInstance()->Get(ID_TEX_BBOX);
+	LPTEXTURE bbox = CTextures::GetInstance()->Get(ID_TEX_BBOX);
 
 	float l,t,r,b; 
 
@@ -199,8 +392,40 @@ bool CGameObject::IsInCamera()
 	return true;
 }
 
+/*
+	Same window as IsInCamera, for any part of the cached box
+*/
+bool CGameObject::IsBoxInCamera()
+{
+	CGame* game = CGame::GetInstance();
+	float cx, cy;
+	game->GetCamPos(cx, cy);
+	int scrW = game->GetScreenWidth();
+	int tW = ((CPlayScene*)(game->GetCurrentScene()))->GetMap()->GetTileWidth();
+	return bbox_r >= cx - 2 * tW && bbox_l <= cx + scrW + 2 * tW;
+}
+
+/*
+	(Re)arm the timer kept in handle: callback runs once delay ms have passed, on the
+	current scene's timer wheel
+*/
+void CGameObject::StartTimer(int& handle, DWORD delay, LPTIMERCALLBACK callback)
+{
+	CTimerWheel* timers = CGame::GetInstance()->GetCurrentScene()->GetTimers();
+	timers->Cancel(handle);
+	handle = timers->Schedule(this, delay, callback);
+}
+
+void CGameObject::StopTimer(int& handle)
+{
+	CGame::GetInstance()->GetCurrentScene()->GetTimers()->Cancel(handle);
+	handle = TIMER_NONE;
+}
+
 CGameObject::~CGameObject()
 {
+	if (armedTimers > 0)
+		CGame::GetInstance()->GetCurrentScene()->GetTimers()->CancelAll(this);
 	/*delete this->animation_set;
 	this->animation_set = nullptr;*/
 }
\ No newline at end of file
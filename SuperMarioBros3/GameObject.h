@@ -1,8 +1,8 @@
 #pragma once
 
 #include <Windows.h>
-#include <d3dx9.h>
 #include <vector>
+#include <string>
 
 #include "Sprites.h"
 #include "Animations.h"
@@ -12,9 +12,26 @@ using namespace std;
 
 #define ID_TEX_BBOX -100		// special texture to draw object bounding box
 
+// object kinds, used to pick the collision response without RTTI
+#define OBJECT_KIND_UNKNOWN			0
+#define OBJECT_KIND_BRICK			1
+#define OBJECT_KIND_REWARD_BOX		2
+#define OBJECT_KIND_GOOMBA			3
+#define OBJECT_KIND_KOOPA			4
+#define OBJECT_KIND_PLANT			5
+#define OBJECT_KIND_MARIO			6
+#define OBJECT_KIND_ITEM			7
+#define OBJECT_KIND_PORTAL			8
+#define OBJECT_KIND_MOVING_PLATFORM	9
+#define OBJECT_KIND_BULLET_MARIO	10
+#define OBJECT_KIND_SWITCH_BLOCK	11
+#define OBJECT_KIND_COUNT			12
+
 class CGameObject; 
 typedef CGameObject * LPGAMEOBJECT;
 
+class CSnapshot;
+
 struct CCollisionEvent;
 typedef CCollisionEvent * LPCOLLISIONEVENT;
 struct CCollisionEvent
@@ -24,6 +41,7 @@ struct CCollisionEvent
 	
 	float dx, dy;		// *RELATIVE* movement distance between this object and obj
 
+	CCollisionEvent() {}
 	CCollisionEvent(float t, float nx, float ny, float dx = 0, float dy = 0, LPGAMEOBJECT obj = NULL) 
 	{ 
 		this->t = t; 
@@ -34,12 +52,36 @@ struct CCollisionEvent
 		this->obj = obj; 
 	}
 
-	static bool compare(const LPCOLLISIONEVENT &a, LPCOLLISIONEVENT &b)
+	static bool compare(const CCollisionEvent &a, const CCollisionEvent &b)
+	{
+		return a.t < b.t;
+	}
+};
+
+/*
+	What FilterCollision found this frame, shared by every response of one Update
+*/
+struct CCollisionContext
+{
+	float min_tx, min_ty;
+	float nx, ny;
+	float x0, y0;			// position before moving
+
+	CCollisionContext(float min_tx, float min_ty, float nx, float ny, float x0, float y0)
 	{
-		return a->t < b->t;
+		this->min_tx = min_tx;
+		this->min_ty = min_ty;
+		this->nx = nx;
+		this->ny = ny;
+		this->x0 = x0;
+		this->y0 = y0;
 	}
 };
 
+typedef void (CGameObject::*LPCOLLISIONRESPONSE)(LPCOLLISIONEVENT e, CCollisionContext& c);
+
+typedef void (CGameObject::*LPTIMERCALLBACK)();
+
 
 class CGameObject
 {
@@ -60,11 +102,32 @@ public:
 	float ax, ay;
 
 	int state = 0;
+	int kind = OBJECT_KIND_UNKNOWN;
 
 	DWORD dt = 0; 
 
+	// position at the start of the last simulation step, rendering blends it with x, y
+	float prev_x = 0;
+	float prev_y = 0;
+	bool hasPrevPosition = false;
+
 	LPANIMATION_SET animation_set;
 
+	int armedTimers = 0;	// timers of the scene's timer wheel still waiting to call this object
+
+	// responses indexed by [self kind][other kind], empty when nothing has to happen
+	static LPCOLLISIONRESPONSE collisionResponses[OBJECT_KIND_COUNT][OBJECT_KIND_COUNT];
+	static bool InitCollisionResponses();
+	static void SetCollisionResponse(int selfKind, int otherKind, LPCOLLISIONRESPONSE response);
+
+	// collision storage reused every frame, so Update does not allocate once it has grown
+	vector<CCollisionEvent> coEvents;
+	vector<LPCOLLISIONEVENT> coEventsResult;
+	vector<LPGAMEOBJECT> nearby;
+
+	// GetBoundingBox as of the last RefreshBoundingBox, read by the collision code
+	float bbox_l = 0, bbox_t = 0, bbox_r = 0, bbox_b = 0;
+
 public: 
 	bool IsEnable = true;
 	void SetPosition(float x, float y) { this->x = x, this->y = y; }
@@ -75,13 +138,49 @@ public:
 	int GetState() { return this->state; }
 
 	void RenderBoundingBox();
+	void RenderInterpolated();
+
+	void StartTimer(int& handle, DWORD delay, LPTIMERCALLBACK callback);
+	void StopTimer(int& handle);
+
+	/*
+		Call after the position or state changed, so other objects' collision tests see the
+		new box without a virtual GetBoundingBox per pair
+	*/
+	void RefreshBoundingBox() { GetBoundingBox(bbox_l, bbox_t, bbox_r, bbox_b); }
+	void GetCachedBoundingBox(float &left, float &top, float &right, float &bottom)
+	{
+#ifdef _DEBUG
+		CheckCachedBoundingBox();
+#endif
+		left = bbox_l;
+		top = bbox_t;
+		right = bbox_r;
+		bottom = bbox_b;
+	}
+#ifdef _DEBUG
+	void CheckCachedBoundingBox();
+#endif
 
 	void SetAnimationSet(LPANIMATION_SET ani_set) { animation_set = ani_set; }
 
-	LPCOLLISIONEVENT SweptAABBEx(LPGAMEOBJECT coO);
-	void CalcPotentialCollisions(vector<LPGAMEOBJECT> *coObjects, vector<LPCOLLISIONEVENT> &coEvents);
+	CCollisionEvent SweptAABBEx(LPGAMEOBJECT coO);
+	void SweptAABBEx(vector<LPGAMEOBJECT>& coObjects, vector<CCollisionEvent>& coEvents);
+	void GetNearbyObjects(vector<LPGAMEOBJECT>* coObjects, float l, float t, float r, float b, vector<LPGAMEOBJECT>& nearby);
+	void GetNearbyObjects(vector<LPGAMEOBJECT>* coObjects, vector<LPGAMEOBJECT>& nearby);
+	void CalcPotentialCollisions(vector<LPGAMEOBJECT> *coObjects, vector<CCollisionEvent> &coEvents);
+	void RespondToCollision(LPCOLLISIONEVENT e, CCollisionContext& c)
+	{
+		LPCOLLISIONRESPONSE response = collisionResponses[kind][e->obj->kind];
+		if (response != NULL)
+		{
+			(this->*response)(e, c);
+			// the response may have moved the other object or changed its state
+			e->obj->RefreshBoundingBox();
+		}
+	}
 	void FilterCollision(
-		vector<LPCOLLISIONEVENT> &coEvents, 
+		vector<CCollisionEvent> &coEvents, 
 		vector<LPCOLLISIONEVENT> &coEventsResult, 
 		float &min_tx, 
 		float &min_ty, 
@@ -92,6 +191,22 @@ public:
 
 	CGameObject();
 
+	// objects start zeroed: members their constructors leave out read as 0, false or NULL
+	// on every platform instead of whatever the heap held before. They live in the world's
+	// CObjectHeap, where a snapshot can find them
+	static void* operator new(size_t size);
+	static void operator delete(void* p);
+
+	/*
+		A snapshot saves the object as a copy of its bytes, which cannot carry the storage
+		of its vectors. SaveContainers writes what they hold, ReleaseContainers frees their
+		storage before the bytes are copied back over them and LoadContainers builds them
+		again in place. Classes adding vectors extend all three
+	*/
+	virtual void SaveContainers(CSnapshot& s) {}
+	virtual void ReleaseContainers();
+	virtual void LoadContainers(CSnapshot& s);
+
 	virtual void GetBoundingBox(float &left, float &top, float &right, float &bottom) = 0;
 	virtual void Update(DWORD dt, vector<LPGAMEOBJECT> *coObjects = NULL);
 	virtual void Render() = 0;
@@ -99,6 +214,7 @@ public:
 
 	virtual bool IsUpdatable() { return true; };
 	bool IsInCamera();
+	bool IsBoxInCamera();		// by the cached box: a merged brick can start left of the view
 	virtual ~CGameObject();
 };
 
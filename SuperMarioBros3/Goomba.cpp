@@ -7,6 +7,7 @@
 #include "IntroScene.h"
 CGoomba::CGoomba(float _x, float _y, int _type):CEnemy(_x, _y, _type)
 {
+	kind = OBJECT_KIND_GOOMBA;
 	if (type == GOOMBA_TYPE_FLYING_RED)
 	{
 		leftWing = new CWing(WING_TYPE_LEFT);
@@ -14,7 +15,7 @@ CGoomba::CGoomba(float _x, float _y, int _type):CEnemy(_x, _y, _type)
 	}
 	SetState(GOOMBA_STATE_WALKING);
 	this->PARA_jumpStack = 0;
-	loop_start = (DWORD)GetTickCount64();
+	loop_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 }
 CGoomba::~CGoomba()
 {
@@ -64,7 +65,7 @@ void CGoomba::Update_FlyingRed()
 	//update vx to attack on mario 
 	if (IsTouchingGround)
 	{
-		if ((GetTickCount64() - loop_start) > GOOMBA_TIME_PARA_OPERATION_LOOP && PARA_jumpStack == 0)
+		if ((CGame::GetInstance()->GetSceneTime() - loop_start) > GOOMBA_TIME_PARA_OPERATION_LOOP && PARA_jumpStack == 0)
 		{
 			CMario* mario = ((CPlayScene*)CGame::GetInstance()->GetCurrentScene())->GetPlayer();
 			float ml, mt, mr, mb;
@@ -80,10 +81,10 @@ void CGoomba::Update_FlyingRed()
 	//update jumping
 	if (IsTouchingGround)
 	{
-		if ((GetTickCount64() - loop_start) > GOOMBA_TIME_PARA_OPERATION_LOOP && PARA_jumpStack == 0 )
+		if ((CGame::GetInstance()->GetSceneTime() - loop_start) > GOOMBA_TIME_PARA_OPERATION_LOOP && PARA_jumpStack == 0 )
 		{
 			SetState(GOOMBA_STATE_JUMPING);
-			loop_start = (DWORD)GetTickCount64();
+			loop_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 			PARA_jumpStack++;
 		}
 		else if (PARA_jumpStack > 0 && PARA_jumpStack < GOOMBA_PARA_MAX_JUMP_STACK)
@@ -145,8 +146,6 @@ void CGoomba::Update(DWORD dt, vector<LPGAMEOBJECT> *coObjects)
 	if (type == GOOMBA_TYPE_FLYING_RED)
 		Update_FlyingRed();
 	
-	vector<LPCOLLISIONEVENT> coEvents;
-	vector<LPCOLLISIONEVENT> coEventsResult;
 
 	coEvents.clear();
 	CalcPotentialCollisions(coObjects, coEvents);
@@ -170,46 +169,13 @@ void CGoomba::Update(DWORD dt, vector<LPGAMEOBJECT> *coObjects)
 		x = x0 + dx;
 		y = y0 + dy;
 
+		CCollisionContext c(min_tx, min_ty, nx, ny, x0, y0);
 		for (UINT i = 0; i < coEventsResult.size(); i++)
-		{
-			LPCOLLISIONEVENT e = coEventsResult[i];
-			if (dynamic_cast<CBrick*>(e->obj))
-			{
-				if (nx != 0)
-				{
-					this->x = x0 + min_tx * this->dx + nx * 0.1f;
-					this->vx = -vx;
-				}
-				if (ny != 0)
-				{
-					IsTouchingGround = true;
-					if(state != GOOMBA_STATE_IDLE)
-						state = GOOMBA_STATE_WALKING;
-					if (type == GOOMBA_TYPE_FLYING_RED)
-					{
-						leftWing->SetState(WING_STATE_IDLE);
-						rightWing->SetState(WING_STATE_IDLE);
-					}
-					this->vy = 0;
-					this->y = y0 + min_ty * this->dy + ny * 0.1f;
-					
-				}
-			}
-			else if (dynamic_cast<CMario*>(e->obj))
-			{
-				/*if (nx != 0)
-				{
-					this->x = x0 + min_tx * this->dx + nx * 0.1f;
-					this->vx = -vx;
-				}*/
-			}
-
-		}
+			RespondToCollision(coEventsResult[i], c);
 
 	}
 	CalculateBeSwingedTail();
 	 //clean up collision events
-	for (UINT i = 0; i < coEvents.size(); i++) delete coEvents[i];
 	if (type == GOOMBA_TYPE_FLYING_RED)
 		Update_Wings();
 
@@ -228,7 +194,7 @@ void CGoomba::Render()
 		else if (this->state == GOOMBA_STATE_DIE_Y)
 		{
 			ani = GOOMBA_ANI_NORMAL_DIE_Y;
-			if (DeadTime != 0 && (GetTickCount64() - this->DeadTime) >= GOOMBA_TIME_TO_STOP_RENDERING)
+			if (DeadTime != 0 && (CGame::GetInstance()->GetSceneTime() - this->DeadTime) >= GOOMBA_TIME_TO_STOP_RENDERING)
 				return;
 		}
 		else if (state == GOOMBA_STATE_DIE_X)
@@ -241,7 +207,7 @@ void CGoomba::Render()
 		if (this->state == GOOMBA_STATE_DIE_Y)
 		{
 			ani = GOOMBA_ANI_RED_DIE_Y;
-			if (DeadTime != 0 && (GetTickCount64() - this->DeadTime) >= GOOMBA_TIME_TO_STOP_RENDERING)
+			if (DeadTime != 0 && (CGame::GetInstance()->GetSceneTime() - this->DeadTime) >= GOOMBA_TIME_TO_STOP_RENDERING)
 				return;
 		}
 		else if (state == GOOMBA_STATE_DIE_X)
@@ -312,7 +278,7 @@ void CGoomba::SetState(int state)
 }
 void CGoomba::SetDeadTime()
 {
-	this->DeadTime =(DWORD) GetTickCount64();
+	this->DeadTime =(DWORD) CGame::GetInstance()->GetSceneTime();
 }
 void CGoomba::CalculateBeSwingedTail()
 {
@@ -376,6 +342,34 @@ void CGoomba::Reset()
 	}
 	SetState(GOOMBA_STATE_WALKING);
 	this->PARA_jumpStack = 0;
-	loop_start =(DWORD) GetTickCount64();
+	loop_start =(DWORD) CGame::GetInstance()->GetSceneTime();
 	IsEnable = false;
-}
\ No newline at end of file
+}
+
+void CGoomba::RegisterCollisionResponses()
+{
+	SetCollisionResponse(OBJECT_KIND_GOOMBA, OBJECT_KIND_BRICK, (LPCOLLISIONRESPONSE)&CGoomba::OnCollisionWithBrick);
+}
+
+void CGoomba::OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	if (c.nx != 0)
+	{
+		this->x = c.x0 + c.min_tx * this->dx + c.nx * 0.1f;
+		this->vx = -vx;
+	}
+	if (c.ny != 0)
+	{
+		IsTouchingGround = true;
+		if(state != GOOMBA_STATE_IDLE)
+			state = GOOMBA_STATE_WALKING;
+		if (type == GOOMBA_TYPE_FLYING_RED)
+		{
+			leftWing->SetState(WING_STATE_IDLE);
+			rightWing->SetState(WING_STATE_IDLE);
+		}
+		this->vy = 0;
+		this->y = c.y0 + c.min_ty * this->dy + c.ny * 0.1f;
+		
+	}
+}
@@ -80,4 +80,6 @@ public:
 
 	void Reset();
 
+	static void RegisterCollisionResponses();
+	void OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c);
 };
\ No newline at end of file
@@ -1,11 +1,19 @@
 #include "Grid.h"
 #include "Utils.h"
+#include "Game.h"
+#include "PlayScence.h"
+#include "ObjectHeap.h"
+#include "Snapshot.h"
 
 #define CELL_WIDTH	150
 #define CELL_HEIGHT 150
 #define SCREEN_WIDTH	270
 #define SCREEN_HEIGHT	250
 
+// objects are put in cells by their top-left corner, so a broadphase query has to look
+// this far around the box to catch the ones reaching into it (widest is the moving platform)
+#define BROADPHASE_MARGIN	48
+
 CUnit::CUnit(CGrid* _grid, LPGAMEOBJECT _obj)
 {
 	this->grid = _grid;
@@ -16,6 +24,10 @@ CUnit::CUnit(CGrid* _grid, LPGAMEOBJECT _obj)
 	this->prev = NULL;
 	this->next = NULL;
 
+	this->isActive = false;
+	this->activePrev = NULL;
+	this->activeNext = NULL;
+
 	grid->Add(this);
 }
 
@@ -29,6 +41,10 @@ CUnit::CUnit(int _gridRow, int _gridCol,CGrid* _grid, LPGAMEOBJECT _obj)
 	this->prev = NULL;
 	this->next = NULL;
 
+	this->isActive = false;
+	this->activePrev = NULL;
+	this->activeNext = NULL;
+
 	grid->Add(this, _gridRow, _gridCol);
 }
 
@@ -38,6 +54,16 @@ void CUnit::Move(float x, float y)
 
 }
 
+void* CUnit::operator new(size_t size)
+{
+	return CObjectHeap::Alloc(size, HEAP_BLOCK_UNIT);
+}
+
+void CUnit::operator delete(void* p)
+{
+	CObjectHeap::Free(p);
+}
+
 
 
 
@@ -79,6 +105,9 @@ void CGrid::Add(CUnit* unit)
 	cells[row][col] = unit;
 	if (unit->next != NULL)
 		unit->next->prev = unit;
+
+	if (IsActiveCell(row, col))
+		Activate(unit);
 }
 void CGrid::Add(CUnit* unit, int gridRow, int gridCol)
 {
@@ -92,6 +121,9 @@ void CGrid::Add(CUnit* unit, int gridRow, int gridCol)
 	cells[gridRow][gridCol] = unit;
 	if (unit->next != NULL)
 		unit->next->prev = unit;
+
+	if (IsActiveCell(gridRow, gridCol))
+		Activate(unit);
 }
 
 void CGrid::Move(CUnit* unit, float x, float y)
@@ -125,10 +157,76 @@ void CGrid::Move(CUnit* unit, float x, float y)
 	if (cells[oldRow][oldCol] == unit)
 		cells[oldRow][oldCol] = unit->next;
 
+	if (unit->isActive)
+		Deactivate(unit);
+
 	Add(unit);
 }
 
-void CGrid::Get(float cam_x, float cam_y, vector<CUnit*>& listUnits)
+bool CGrid::IsActiveCell(int row, int col)
+{
+	return row >= activeStartRow && row < activeEndRow && col >= activeStartCol && col < activeEndCol;
+}
+
+void CGrid::Activate(CUnit* unit)
+{
+	unit->isActive = true;
+	unit->activePrev = NULL;
+	unit->activeNext = activeUnits;
+	if (activeUnits != NULL)
+		activeUnits->activePrev = unit;
+	activeUnits = unit;
+}
+
+void CGrid::Deactivate(CUnit* unit)
+{
+	if (unit->activePrev != NULL)
+		unit->activePrev->activeNext = unit->activeNext;
+	else
+		activeUnits = unit->activeNext;
+	if (unit->activeNext != NULL)
+		unit->activeNext->activePrev = unit->activePrev;
+
+	unit->isActive = false;
+	unit->activePrev = NULL;
+	unit->activeNext = NULL;
+}
+
+/*
+	Push a cell's units to the front of the active set, keeping the cell's own order
+	(the cell head stays in front so it's still rendered on top, e.g. pipes over plants)
+*/
+void CGrid::ActivateCell(int row, int col)
+{
+	CUnit* unit = cells[row][col];
+	if (unit == NULL)
+		return;
+	while (unit->next != NULL)
+		unit = unit->next;
+	while (unit != NULL)
+	{
+		if (!unit->isActive)
+			Activate(unit);
+		unit = unit->prev;
+	}
+}
+
+void CGrid::DeactivateCell(int row, int col)
+{
+	CUnit* unit = cells[row][col];
+	while (unit != NULL)
+	{
+		if (unit->isActive)
+			Deactivate(unit);
+		unit = unit->next;
+	}
+}
+
+/*
+	Slide the active window to the camera. Only the cells that leave or enter the
+	window are visited, so a camera moving inside the same cells costs nothing.
+*/
+void CGrid::UpdateActiveCells(float cam_x, float cam_y)
 {
 	int startCol = (int)(cam_x / CELL_WIDTH);
 	int endCol = (int)ceil((cam_x + SCREEN_WIDTH) / CELL_WIDTH);
@@ -144,18 +242,217 @@ void CGrid::Get(float cam_x, float cam_y, vector<CUnit*>& listUnits)
 	int ENDROW = (int)ceil((mapHeight / CELL_HEIGHT));
 	if (endRow > ENDROW)
 		endRow = ENDROW;
+
+	if (startRow == activeStartRow && endRow == activeEndRow &&
+		startCol == activeStartCol && endCol == activeEndCol)
+		return;
+
+	for (int i = activeStartRow; i < activeEndRow; i++)
+		for (int j = activeStartCol; j < activeEndCol; j++)
+			if (i < startRow || i >= endRow || j < startCol || j >= endCol)
+				DeactivateCell(i, j);
+
+	int oldStartRow = activeStartRow, oldEndRow = activeEndRow;
+	int oldStartCol = activeStartCol, oldEndCol = activeEndCol;
+	activeStartRow = startRow;
+	activeEndRow = endRow;
+	activeStartCol = startCol;
+	activeEndCol = endCol;
+
+	for (int i = startRow; i < endRow; i++)
+		for (int j = startCol; j < endCol; j++)
+			if (i < oldStartRow || i >= oldEndRow || j < oldStartCol || j >= oldEndCol)
+				ActivateCell(i, j);
+}
+
+/*
+	Same bounds as CGameObject::IsInCamera, computed once instead of per object
+*/
+void CGrid::GetCameraBounds(float cam_x, float& left, float& right)
+{
+	CGame* game = CGame::GetInstance();
+	int tW = ((CPlayScene*)game->GetCurrentScene())->GetMap()->GetTileWidth();
+	left = cam_x - 2.0f * tW;
+	right = cam_x + game->GetScreenWidth() + 2.0f * tW;
+}
+
+void CGrid::Get(float cam_x, float cam_y, vector<CUnit*>& listUnits)
+{
+	UpdateActiveCells(cam_x, cam_y);
+
+	float left, right;
+	GetCameraBounds(cam_x, left, right);
+
+	for (CUnit* unit = activeUnits; unit != NULL; unit = unit->activeNext)
+	{
+		float x = unit->obj->x;
+		if (x < left || x > right)
+			continue;
+		listUnits.push_back(unit);
+	}
+}
+
+void CGrid::AddStatic(LPGAMEOBJECT obj, int gridRow, int gridCol, bool collidable)
+{
+	if (gridRow == this->numRows)
+		gridRow = this->numRows - 1;
+	if (gridCol == this->numCols)
+		gridCol = this->numCols - 1;
+
+	CStaticCollider collider;
+	obj->RefreshBoundingBox();
+	obj->GetCachedBoundingBox(collider.l, collider.t, collider.r, collider.b);
+	collider.obj = obj;
+	collider.collidable = collidable;
+
+	statics.push_back(collider);
+	staticCells.push_back(gridRow * numCols + gridCol);
+}
+
+/*
+	Sort the static colliders by cell (keeping load order inside a cell) and build
+	the cell offset table. Call once, after every static object has been added.
+*/
+void CGrid::BuildStaticLayer()
+{
+	int totalCells = numRows * numCols;
+	staticCellStart.assign(totalCells + 1, 0);
+	for (size_t i = 0; i < staticCells.size(); i++)
+		staticCellStart[staticCells[i] + 1]++;
+	for (int i = 0; i < totalCells; i++)
+		staticCellStart[i + 1] += staticCellStart[i];
+
+	for (size_t i = 0; i < statics.size(); i++)
+	{
+		staticMaxWidth = max(staticMaxWidth, statics[i].r - statics[i].l);
+		staticMaxHeight = max(staticMaxHeight, statics[i].b - statics[i].t);
+	}
+
+	vector<CStaticCollider> sorted(statics.size());
+	vector<int> fill(staticCellStart.begin(), staticCellStart.end() - 1);
+	for (size_t i = 0; i < statics.size(); i++)
+		sorted[fill[staticCells[i]]++] = statics[i];
+
+	statics.swap(sorted);
+	staticCells.clear();
+	staticCells.shrink_to_fit();
+
+	DebugOut(L"[INFO] Static layer built: %d colliders\n", (int)statics.size());
+}
+
+void CGrid::GetStatic(float cam_x, float cam_y, vector<LPGAMEOBJECT>& listObjects)
+{
+	if (staticCellStart.empty())
+		return;
+
+	UpdateActiveCells(cam_x, cam_y);
+
+	float left, right;
+	GetCameraBounds(cam_x, left, right);
+
+	for (int i = activeStartRow; i < activeEndRow; i++)
+	{
+		int first = staticCellStart[i * numCols + activeStartCol];
+		int last = staticCellStart[i * numCols + activeEndCol];
+		for (int k = first; k < last; k++)
+		{
+			if (statics[k].r < left || statics[k].l > right)
+				continue;
+			listObjects.push_back(statics[k].obj);
+		}
+	}
+}
+
+void CGrid::GetCellRange(float l, float t, float r, float b, int& startRow, int& endRow, int& startCol, int& endCol)
+{
+	startCol = (int)(l / CELL_WIDTH);
+	endCol = (int)(r / CELL_WIDTH) + 1;
+	startRow = (int)(t / CELL_HEIGHT);
+	endRow = (int)(b / CELL_HEIGHT) + 1;
+
+	if (startCol < 0)
+		startCol = 0;
+	if (endCol > numCols)
+		endCol = numCols;
+	if (startRow < 0)
+		startRow = 0;
+	if (endRow > numRows)
+		endRow = numRows;
+
+	// a box wholly off the map gets an empty range that still indexes the static table
+	startCol = min(startCol, numCols);
+	startRow = min(startRow, numRows);
+	endCol = max(endCol, startCol);
+	endRow = max(endRow, startRow);
+}
+
+/*
+	Broadphase query: the objects that may collide with a mover whose swept box is (l, t, r, b).
+	Static colliders are tested against their cached box (the same test as the broad-phase
+	of CGame::SweptAABB), moving objects are taken from the cells around the box, only the
+	ones Get gives the scene this frame: the others are frozen and not drawn, and their
+	cached boxes are not refreshed.
+*/
+void CGrid::GetCollidables(float l, float t, float r, float b, LPGAMEOBJECT self, vector<LPGAMEOBJECT>& listObjects)
+{
+	int startRow, endRow, startCol, endCol;
+
+	if (!staticCellStart.empty())
+	{
+		GetCellRange(l - staticMaxWidth, t - staticMaxHeight, r, b, startRow, endRow, startCol, endCol);
+		for (int i = startRow; i < endRow; i++)
+		{
+			int first = staticCellStart[i * numCols + startCol];
+			int last = staticCellStart[i * numCols + endCol];
+			for (int k = first; k < last; k++)
+			{
+				CStaticCollider& s = statics[k];
+				if (!s.collidable || r < s.l || l > s.r || b < s.t || t > s.b)
+					continue;
+				listObjects.push_back(s.obj);
+			}
+		}
+	}
+
+	float cam_x, cam_y, left, right;
+	CGame::GetInstance()->GetCamPos(cam_x, cam_y);
+	GetCameraBounds(cam_x, left, right);
+
+	GetCellRange(l - BROADPHASE_MARGIN, t - BROADPHASE_MARGIN, r + BROADPHASE_MARGIN, b + BROADPHASE_MARGIN,
+		startRow, endRow, startCol, endCol);
 	for (int i = startRow; i < endRow; i++)
 	{
 		for (int j = startCol; j < endCol; j++)
 		{
-			CUnit* unit = cells[i][j];
-			while (unit != NULL)
+			for (CUnit* unit = cells[i][j]; unit != NULL; unit = unit->next)
 			{
-				if (unit->GetObj()->IsInCamera())
-					listUnits.push_back(unit);
-				unit = unit->next;
+				float x = unit->obj->x;
+				if (!unit->isActive || x < left || x > right || unit->obj == self)
+					continue;
+				listObjects.push_back(unit->obj);
 			}
 		}
 	}
 }
 
+void CGrid::Save(CSnapshot& s)
+{
+	for (int i = 0; i < numRows; i++)
+		s.Write(&cells[i][0], numCols * sizeof(CUnit*));
+	s.Write(activeStartRow);
+	s.Write(activeEndRow);
+	s.Write(activeStartCol);
+	s.Write(activeEndCol);
+	s.Write(activeUnits);
+}
+
+void CGrid::Load(CSnapshot& s)
+{
+	for (int i = 0; i < numRows; i++)
+		s.Read(&cells[i][0], numCols * sizeof(CUnit*));
+	s.Read(activeStartRow);
+	s.Read(activeEndRow);
+	s.Read(activeStartCol);
+	s.Read(activeEndCol);
+	s.Read(activeUnits);
+}
@@ -1,5 +1,8 @@
 #pragma once
 #include "GameObject.h"
+
+class CGrid;
+
 class CUnit
 {
 	friend class CGrid;
@@ -12,6 +15,11 @@ private:
 
 	CUnit* prev;
 	CUnit* next;
+
+	// links in the grid's active set (units of the cells inside the camera window)
+	bool isActive;
+	CUnit* activePrev;
+	CUnit* activeNext;
 public:
 	CUnit(CGrid* _grid, LPGAMEOBJECT _obj);
 	CUnit(int gridRow, int gridCol, CGrid* _grid, LPGAMEOBJECT _obj);
@@ -19,6 +27,21 @@ public:
 	void Move(float _x, float _y);
 	LPGAMEOBJECT GetObj() { return this->obj; }
 
+	// units live in the world's CObjectHeap next to their objects, see CGameObject
+	static void* operator new(size_t size);
+	static void operator delete(void* p);
+
+};
+
+/*
+	Entry of the static layer: a collider that never moves (bricks, pipes, portals),
+	its bounding box is read once at load time
+*/
+struct CStaticCollider
+{
+	float l, t, r, b;
+	LPGAMEOBJECT obj;
+	bool collidable;	// false when the map tile layer already collides for it
 };
 
 class CGrid
@@ -31,6 +54,31 @@ class CGrid
 	int numRows;
 
 	vector <vector<CUnit*>> cells;
+
+	// camera window in cells [start, end), kept between frames so only the
+	// rows/columns entering or leaving the view have to be visited
+	int activeStartRow = 0;
+	int activeEndRow = 0;
+	int activeStartCol = 0;
+	int activeEndCol = 0;
+	CUnit* activeUnits = NULL;
+
+	// static layer: one flat array sorted by cell, the colliders of cell (row, col)
+	// are statics[staticCellStart[row * numCols + col] .. staticCellStart[row * numCols + col + 1])
+	vector<CStaticCollider> statics;
+	vector<int> staticCells;
+	vector<int> staticCellStart;
+	float staticMaxWidth = 0;		// colliders are put in cells by their top-left corner, a query
+	float staticMaxHeight = 0;		// has to look this far up and left to find the ones reaching it
+
+	bool IsActiveCell(int row, int col);
+	void Activate(CUnit* unit);
+	void Deactivate(CUnit* unit);
+	void ActivateCell(int row, int col);
+	void DeactivateCell(int row, int col);
+	void UpdateActiveCells(float cam_x, float cam_y);
+	void GetCameraBounds(float cam_x, float& left, float& right);
+	void GetCellRange(float l, float t, float r, float b, int& startRow, int& endRow, int& startCol, int& endCol);
 public:
 	CGrid(int _numRows, int _numCols);
 	~CGrid();
@@ -39,4 +87,14 @@ public:
 	void Add(CUnit* unit, int gridRow, int gridCol);
 	void Move(CUnit* unit, float x, float y);
 	void Get(float cam_x, float cam_y, vector<CUnit*>& listUnits);
-};
\ No newline at end of file
+
+	void AddStatic(LPGAMEOBJECT obj, int gridRow, int gridCol, bool collidable = true);
+	void BuildStaticLayer();
+	void GetStatic(float cam_x, float cam_y, vector<LPGAMEOBJECT>& listObjects);
+
+	void GetCollidables(float l, float t, float r, float b, LPGAMEOBJECT self, vector<LPGAMEOBJECT>& listObjects);
+
+	// the cell lists and the active window, the static layer never changes after loading
+	void Save(CSnapshot& s);
+	void Load(CSnapshot& s);
+};
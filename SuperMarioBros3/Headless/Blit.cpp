@@ -0,0 +1,212 @@
+#include "Blit.h"
+
+#if !defined(SMB3_BLIT_SCALAR)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLIT_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define BLIT_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#define BLIT_OPAQUE		0xff000000u
+
+// x / 255 rounded, exact for x up to 255 * 255
+static inline uint32_t Div255(uint32_t x)
+{
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t BlendPixel(uint32_t d, uint32_t s, uint32_t alpha)
+{
+	uint32_t a = Div255((s >> 24) * alpha);
+	uint32_t r = Div255((s & 0xff) * a + (d & 0xff) * (255 - a));
+	uint32_t g = Div255((s >> 8 & 0xff) * a + (d >> 8 & 0xff) * (255 - a));
+	uint32_t b = Div255((s >> 16 & 0xff) * a + (d >> 16 & 0xff) * (255 - a));
+	return BLIT_OPAQUE | b << 16 | g << 8 | r;
+}
+
+#if defined(BLIT_SSE2)
+
+// the same as Div255 on each 16 bit lane
+static inline __m128i Div255x8(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// two pixels of 16 bit channels
+static inline __m128i Blend2(__m128i d, __m128i s, __m128i alpha)
+{
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	a = Div255x8(_mm_mullo_epi16(a, alpha));
+	__m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	return Div255x8(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv)));
+}
+
+void BlitKeyed(uint32_t* dst, const uint32_t* src, int count)
+{
+	const __m128i alphaMask = _mm_set1_epi32((int)BLIT_OPAQUE);
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i clear = _mm_cmpeq_epi32(_mm_and_si128(s, alphaMask), _mm_setzero_si128());
+		__m128i out = _mm_or_si128(_mm_and_si128(clear, d), _mm_andnot_si128(clear, _mm_or_si128(s, alphaMask)));
+		_mm_storeu_si128((__m128i*)(dst + i), out);
+	}
+	for (; i < count; i++)
+		if (src[i] & BLIT_OPAQUE)
+			dst[i] = src[i] | BLIT_OPAQUE;
+}
+
+void BlitBlend(uint32_t* dst, const uint32_t* src, int count, int alpha)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha16 = _mm_set1_epi16((short)alpha);
+	const __m128i alphaMask = _mm_set1_epi32((int)BLIT_OPAQUE);
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i lo = Blend2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), alpha16);
+		__m128i hi = Blend2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), alpha16);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask));
+	}
+	for (; i < count; i++)
+		dst[i] = BlendPixel(dst[i], src[i], alpha);
+}
+
+void ScaleRow(uint32_t* dst, const uint32_t* src, int count, int scale)
+{
+	int i = 0;
+	if (scale == 2)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+			_mm_storeu_si128((__m128i*)(dst + i * 2), _mm_unpacklo_epi32(s, s));
+			_mm_storeu_si128((__m128i*)(dst + i * 2 + 4), _mm_unpackhi_epi32(s, s));
+		}
+	}
+	else if (scale == 4)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+			_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_shuffle_epi32(s, _MM_SHUFFLE(0, 0, 0, 0)));
+			_mm_storeu_si128((__m128i*)(dst + i * 4 + 4), _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 1, 1, 1)));
+			_mm_storeu_si128((__m128i*)(dst + i * 4 + 8), _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 2, 2, 2)));
+			_mm_storeu_si128((__m128i*)(dst + i * 4 + 12), _mm_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3)));
+		}
+	}
+	for (; i < count; i++)
+		for (int k = 0; k < scale; k++)
+			dst[i * scale + k] = src[i];
+}
+
+const char* GetBlitKernels()
+{
+	return "SSE2";
+}
+
+#elif defined(BLIT_NEON)
+
+// the same as Div255 on each 16 bit lane, narrowed to 8 bits
+static inline uint8x8_t Div255x8(uint16x8_t x)
+{
+	x = vaddq_u16(x, vdupq_n_u16(128));
+	return vshrn_n_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), 8);
+}
+
+void BlitKeyed(uint32_t* dst, const uint32_t* src, int count)
+{
+	const uint32x4_t alphaMask = vdupq_n_u32(BLIT_OPAQUE);
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint32x4_t s = vld1q_u32(src + i);
+		uint32x4_t d = vld1q_u32(dst + i);
+		uint32x4_t shown = vtstq_u32(s, alphaMask);
+		vst1q_u32(dst + i, vbslq_u32(shown, vorrq_u32(s, alphaMask), d));
+	}
+	for (; i < count; i++)
+		if (src[i] & BLIT_OPAQUE)
+			dst[i] = src[i] | BLIT_OPAQUE;
+}
+
+void BlitBlend(uint32_t* dst, const uint32_t* src, int count, int alpha)
+{
+	const uint8x8_t alpha8 = vdup_n_u8((uint8_t)alpha);
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		uint8x8x4_t s = vld4_u8((const uint8_t*)(src + i));
+		uint8x8x4_t d = vld4_u8((const uint8_t*)(dst + i));
+		uint8x8_t a = Div255x8(vmull_u8(s.val[3], alpha8));
+		uint8x8_t inv = vmvn_u8(a);
+
+		uint8x8x4_t out;
+		for (int c = 0; c < 3; c++)
+			out.val[c] = Div255x8(vmlal_u8(vmull_u8(s.val[c], a), d.val[c], inv));
+		out.val[3] = vdup_n_u8(255);
+		vst4_u8((uint8_t*)(dst + i), out);
+	}
+	for (; i < count; i++)
+		dst[i] = BlendPixel(dst[i], src[i], alpha);
+}
+
+void ScaleRow(uint32_t* dst, const uint32_t* src, int count, int scale)
+{
+	int i = 0;
+	if (scale == 2)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			uint32x4_t s = vld1q_u32(src + i);
+			uint32x4x2_t twice = { { s, s } };
+			vst2q_u32(dst + i * 2, twice);
+		}
+	}
+	for (; i < count; i++)
+		for (int k = 0; k < scale; k++)
+			dst[i * scale + k] = src[i];
+}
+
+const char* GetBlitKernels()
+{
+	return "NEON";
+}
+
+#else
+
+void BlitKeyed(uint32_t* dst, const uint32_t* src, int count)
+{
+	for (int i = 0; i < count; i++)
+		if (src[i] & BLIT_OPAQUE)
+			dst[i] = src[i] | BLIT_OPAQUE;
+}
+
+void BlitBlend(uint32_t* dst, const uint32_t* src, int count, int alpha)
+{
+	for (int i = 0; i < count; i++)
+		dst[i] = BlendPixel(dst[i], src[i], alpha);
+}
+
+void ScaleRow(uint32_t* dst, const uint32_t* src, int count, int scale)
+{
+	for (int i = 0; i < count; i++)
+		for (int k = 0; k < scale; k++)
+			dst[i * scale + k] = src[i];
+}
+
+const char* GetBlitKernels()
+{
+	return "scalar";
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+/*
+	Row kernels of CSoftwareRenderer. Pixels are 32 bit with the bytes R, G, B, A in memory;
+	what they write to the frame is always opaque. SSE2 on x86 / x64 and NEON on ARM, plain
+	C++ elsewhere or when SMB3_BLIT_SCALAR is defined (to check the others against it)
+*/
+
+// count pixels of src over dst: a pixel of alpha 0 leaves dst as it is, any other replaces it
+void BlitKeyed(uint32_t* dst, const uint32_t* src, int count);
+
+// count pixels of src blended over dst by their alpha times alpha / 255
+void BlitBlend(uint32_t* dst, const uint32_t* src, int count, int alpha);
+
+// count pixels of src, each repeated scale times
+void ScaleRow(uint32_t* dst, const uint32_t* src, int count, int scale);
+
+// "SSE2", "NEON" or "scalar"
+const char* GetBlitKernels();
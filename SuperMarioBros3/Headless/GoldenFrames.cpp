@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <png.h>
+
+#include "GoldenFrames.h"
+
+#define GOLDEN_DIFF_COLOR	0xff0000ffu		// red, opaque
+
+bool WriteFramePng(const string& path, const uint32_t* pixels, int width, int height)
+{
+	png_image image;
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	image.width = width;
+	image.height = height;
+	image.format = PNG_FORMAT_RGBA;
+	return png_image_write_to_file(&image, path.c_str(), 0, pixels, 0, NULL) != 0;
+}
+
+bool ReadFramePng(const string& path, vector<uint32_t>& pixels, int& width, int& height)
+{
+	png_image image;
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_file(&image, path.c_str()))
+		return false;
+
+	image.format = PNG_FORMAT_RGBA;
+	pixels.resize(image.width * image.height);
+	if (!png_image_finish_read(&image, NULL, pixels.data(), 0, NULL))
+		return false;
+
+	width = image.width;
+	height = image.height;
+	return true;
+}
+
+CFrameDiff CompareFrames(const uint32_t* frame, const uint32_t* golden, int width, int height,
+	int tolerance, vector<uint32_t>& diff)
+{
+	CFrameDiff d = { 0, 0, width, height, 0, 0 };
+	diff.resize(width * height);
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+		{
+			int i = y * width + x;
+			uint32_t a = frame[i], b = golden[i];
+			int delta = 0;
+			for (int shift = 0; shift < 32; shift += 8)
+				delta = max(delta, abs((int)(a >> shift & 0xff) - (int)(b >> shift & 0xff)));
+			d.maxDelta = max(d.maxDelta, delta);
+
+			if (delta <= tolerance)
+			{
+				diff[i] = 0xff000000u | (b >> 2 & 0x3f3f3f);
+				continue;
+			}
+			diff[i] = GOLDEN_DIFF_COLOR;
+			d.pixels++;
+			d.left = min(d.left, x);
+			d.top = min(d.top, y);
+			d.right = max(d.right, x + 1);
+			d.bottom = max(d.bottom, y + 1);
+		}
+
+	if (d.pixels == 0)
+		d.left = d.top = 0;
+	return d;
+}
+
+CGoldenFrames::CGoldenFrames(const string& writeDir, const string& checkDir, const string& diffDir, int tolerance)
+{
+	this->writeDir = writeDir;
+	this->checkDir = checkDir;
+	this->diffDir = diffDir;
+	this->tolerance = tolerance;
+}
+
+string CGoldenFrames::FramePath(const string& dir, int frame, const char* suffix)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "frame-%06d%s", frame, suffix);
+	return dir + "/" + name;
+}
+
+void CGoldenFrames::Take(int frame, const uint32_t* pixels, int width, int height)
+{
+	if (!writeDir.empty())
+	{
+		if (WriteFramePng(FramePath(writeDir, frame, ".png"), pixels, width, height))
+			written++;
+		else
+			printf("[ERROR] Cannot write golden frame %d to %s\n", frame, writeDir.c_str());
+	}
+
+	if (checkDir.empty())
+		return;
+	checked++;
+
+	vector<uint32_t> golden;
+	int goldenWidth, goldenHeight;
+	if (!ReadFramePng(FramePath(checkDir, frame, ".png"), golden, goldenWidth, goldenHeight))
+	{
+		printf("golden frame %d: not in %s\n", frame, checkDir.c_str());
+		missing++;
+		return;
+	}
+	if (goldenWidth != width || goldenHeight != height)
+	{
+		printf("golden frame %d: %dx%d, the frame is %dx%d\n", frame, goldenWidth, goldenHeight, width, height);
+		failed.push_back(frame);
+		return;
+	}
+
+	vector<uint32_t> diff;
+	CFrameDiff d = CompareFrames(pixels, golden.data(), width, height, tolerance, diff);
+	if (d.pixels == 0)
+	{
+		if (!diffDir.empty())
+			remove(FramePath(diffDir, frame, ".diff.png").c_str());		// of an earlier check
+		return;
+	}
+
+	printf("golden frame %d: %d pixels differ by up to %d, in (%d, %d) - (%d, %d)\n",
+		frame, d.pixels, d.maxDelta, d.left, d.top, d.right, d.bottom);
+	if (!diffDir.empty())
+		WriteFramePng(FramePath(diffDir, frame, ".diff.png"), diff.data(), width, height);
+	failed.push_back(frame);
+}
+
+bool CGoldenFrames::Report()
+{
+	if (!writeDir.empty())
+		printf("wrote %d golden frames to %s\n", written, writeDir.c_str());
+	if (checkDir.empty())
+		return true;
+
+	if (failed.empty() && missing == 0)
+		printf("golden frames match %s for %d frames, tolerance %d\n", checkDir.c_str(), checked, tolerance);
+	else
+		printf("golden frames differ from %s: %d of %d frames differ, %d have no golden, tolerance %d\n",
+			checkDir.c_str(), (int)failed.size(), checked, missing, tolerance);
+	if (!failed.empty() && !diffDir.empty())
+		printf("diff images of the frames that differ in %s\n", diffDir.c_str());
+	return failed.empty() && missing == 0;
+}
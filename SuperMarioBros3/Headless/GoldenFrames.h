@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define GOLDEN_DEFAULT_EVERY	300		// frames between two goldens when none are chosen
+
+// frames are 32 bit pixels with the bytes R, G, B, A, as CSoftwareRenderer draws them
+bool WriteFramePng(const string& path, const uint32_t* pixels, int width, int height);
+bool ReadFramePng(const string& path, vector<uint32_t>& pixels, int& width, int& height);
+
+struct CFrameDiff
+{
+	int pixels;			// with a channel off by more than the tolerance
+	int maxDelta;		// of a channel, over all the pixels
+	int left, top, right, bottom;	// around the pixels that differ, empty when none do
+};
+
+/*
+	Compares a frame against its golden channel by channel. diff gets an image of it: the
+	golden darkened, with the pixels that differ in red
+*/
+CFrameDiff CompareFrames(const uint32_t* frame, const uint32_t* golden, int width, int height,
+	int tolerance, vector<uint32_t>& diff);
+
+/*
+	Golden frames of a run: frame-NNNNNN.png in a folder, N the frame of the run (counted from
+	0, as the hash logs do). Writes the frames it is given to writeDir and compares them
+	against the ones in checkDir, either can be empty. A frame that differs leaves its diff
+	image in diffDir, as frame-NNNNNN.diff.png, so checking never writes to the goldens. No
+	diff images when diffDir is empty
+*/
+class CGoldenFrames
+{
+	string writeDir;
+	string checkDir;
+	string diffDir;
+	int tolerance;
+
+	int written = 0;
+	int checked = 0;
+	int missing = 0;
+	vector<int> failed;
+
+	string FramePath(const string& dir, int frame, const char* suffix);
+
+public:
+	CGoldenFrames(const string& writeDir, const string& checkDir, const string& diffDir, int tolerance);
+
+	void Take(int frame, const uint32_t* pixels, int width, int height);
+
+	// prints what was written and compared, false when a frame differs or has no golden
+	bool Report();
+};
@@ -0,0 +1,121 @@
+/* =============================================================
+	GYM THROUGHPUT BENCHMARK
+
+	Steps a batch of environments through the C interface with a random policy that leans
+	to the right and jumps now and then, and prints environment steps per second
+
+	usage: smb3_gym_bench [--envs n] [--threads n] [--steps n] [--scene id]
+	                      [--repeat n] [--max-episode n] [--data dir]
+
+================================================================ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "smb3_gym.h"
+
+using namespace std;
+
+#define BENCH_DEFAULT_ENVS	16
+#define BENCH_DEFAULT_STEPS	2000
+
+// fixed seed per env, runs are repeatable
+static uint32_t NextRandom(uint32_t& seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return seed >> 8;
+}
+
+static uint32_t RandomAction(uint32_t& seed)
+{
+	uint32_t r = NextRandom(seed);
+	uint32_t action = (r % 8 < 6) ? SMB3_GYM_RIGHT : (r % 8 == 6 ? SMB3_GYM_LEFT : 0);
+	if ((r >> 4) % 4 == 0) action |= SMB3_GYM_JUMP;
+	if ((r >> 6) % 2 == 0) action |= SMB3_GYM_RUN;
+	return action;
+}
+
+int main(int argc, char* argv[])
+{
+	smb3_gym_config config = { 0 };
+	config.envs = BENCH_DEFAULT_ENVS;
+	int steps = BENCH_DEFAULT_STEPS;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if (arg == "--envs" && hasValue) config.envs = atoi(argv[++i]);
+		else if (arg == "--threads" && hasValue) config.threads = atoi(argv[++i]);
+		else if (arg == "--steps" && hasValue) steps = atoi(argv[++i]);
+		else if (arg == "--scene" && hasValue) config.scene = atoi(argv[++i]);
+		else if (arg == "--repeat" && hasValue) config.action_repeat = atoi(argv[++i]);
+		else if (arg == "--max-episode" && hasValue) config.max_episode_steps = atoi(argv[++i]);
+		else if (arg == "--data" && hasValue) config.data_dir = argv[++i];
+		else
+		{
+			fprintf(stderr,
+				"usage: smb3_gym_bench [--envs n] [--threads n] [--steps n] [--scene id]\n"
+				"                      [--repeat n] [--max-episode n] [--data dir]\n");
+			return 2;
+		}
+	}
+
+	chrono::steady_clock::time_point createStart = chrono::steady_clock::now();
+	smb3_gym* gym = smb3_gym_create(&config);
+	if (gym == NULL)
+	{
+		fprintf(stderr, "[ERROR] Cannot create the environments\n");
+		return 1;
+	}
+	double createTime = chrono::duration<double, milli>(chrono::steady_clock::now() - createStart).count();
+
+	int envs = smb3_gym_env_count(gym);
+	vector<smb3_gym_observation> observations(envs);
+	vector<smb3_gym_result> results(envs);
+	vector<uint32_t> actions(envs);
+	vector<uint32_t> seeds(envs);
+	for (int i = 0; i < envs; i++)
+		seeds[i] = (uint32_t)i * 2654435761u + 1;
+
+	smb3_gym_reset(gym, &observations[0]);
+
+	int episodes = 0, died = 0, cleared = 0, truncated = 0;
+	double distance = 0;
+	long long points = 0;
+
+	chrono::steady_clock::time_point runStart = chrono::steady_clock::now();
+	for (int step = 0; step < steps; step++)
+	{
+		for (int i = 0; i < envs; i++)
+			actions[i] = RandomAction(seeds[i]);
+
+		smb3_gym_step(gym, &actions[0], &observations[0], &results[0]);
+
+		for (int i = 0; i < envs; i++)
+		{
+			distance += results[i].distance;
+			points += results[i].points;
+			episodes += results[i].done;
+			died += results[i].died;
+			cleared += results[i].cleared;
+			truncated += results[i].truncated;
+		}
+	}
+	double runTime = chrono::duration<double, milli>(chrono::steady_clock::now() - runStart).count();
+
+	long long envSteps = (long long)envs * steps;
+	int repeat = config.action_repeat > 0 ? config.action_repeat : 1;
+	printf("%d envs created in %.1f ms\n", envs, createTime);
+	printf("%lld env steps in %.1f ms: %.0f env steps/s (%.0f per env per s), action repeat %d\n",
+		envSteps, runTime, runTime > 0 ? envSteps * 1000.0 / runTime : 0,
+		runTime > 0 ? steps * 1000.0 / runTime : 0, repeat);
+	printf("episodes ended: %d (died %d, cleared %d, truncated %d), distance %.0f px, points %lld\n",
+		episodes, died, cleared, truncated, distance, points);
+
+	smb3_gym_destroy(gym);
+	return 0;
+}
@@ -0,0 +1,53 @@
+#include <unistd.h>
+
+#include "smb3_gym.h"
+#include "GymEnv.h"
+
+struct smb3_gym
+{
+	CGymBatch* batch;
+};
+
+smb3_gym* smb3_gym_create(const smb3_gym_config* config)
+{
+	const char* dataDir = config->data_dir != NULL ? config->data_dir : SMB3_DATA_DIR;
+	if (config->envs <= 0 || chdir(dataDir) != 0)
+		return NULL;
+
+	HeadlessSetClientSize(GYM_SCREEN_WIDTH, GYM_SCREEN_HEIGHT);
+
+	CGymBatch* batch = new CGymBatch(config->threads);
+	if (!batch->Load(*config))
+	{
+		delete batch;
+		return NULL;
+	}
+
+	smb3_gym* gym = new smb3_gym();
+	gym->batch = batch;
+	return gym;
+}
+
+void smb3_gym_destroy(smb3_gym* gym)
+{
+	if (gym == NULL)
+		return;
+	delete gym->batch;
+	delete gym;
+}
+
+int smb3_gym_env_count(smb3_gym* gym)
+{
+	return gym->batch->GetEnvCount();
+}
+
+void smb3_gym_reset(smb3_gym* gym, smb3_gym_observation* observations)
+{
+	gym->batch->Reset(observations);
+}
+
+void smb3_gym_step(smb3_gym* gym, const uint32_t* actions,
+	smb3_gym_observation* observations, smb3_gym_result* results)
+{
+	gym->batch->Step(actions, observations, results);
+}
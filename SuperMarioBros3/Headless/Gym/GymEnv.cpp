@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <math.h>
+
+#include "GymEnv.h"
+#include "../NullRenderer.h"
+#include "../../Utils.h"
+#include "../../Map.h"
+#include "../../Mario.h"
+#include "../../EndSceneNotification.h"
+
+struct CGymKey
+{
+	DWORD action;
+	int keyCode;
+};
+
+static const CGymKey gymKeys[] =
+{
+	{ SMB3_GYM_LEFT, DIK_LEFT }, { SMB3_GYM_RIGHT, DIK_RIGHT }, { SMB3_GYM_UP, DIK_UP },
+	{ SMB3_GYM_DOWN, DIK_DOWN }, { SMB3_GYM_JUMP, DIK_S }, { SMB3_GYM_RUN, DIK_A },
+};
+
+CGymEnv::CGymEnv(int sceneId, int actionRepeat, int maxEpisodeSteps)
+{
+	this->sceneId = sceneId;
+	this->actionRepeat = max(actionRepeat, 1);
+	this->maxEpisodeSteps = maxEpisodeSteps;
+}
+
+CGymEnv::~CGymEnv()
+{
+	if (world == NULL)
+		return;
+	world->MakeCurrent();
+	start.Clear();		// before the world whose objects it holds
+	delete world;
+}
+
+bool CGymEnv::Load()
+{
+	world = new CWorld();
+	world->MakeCurrent();
+
+	keyboard = new CScriptedKeyboard();
+	CGame* game = &world->game;
+	game->Init(NULL, new CNullRenderer(), keyboard);
+	game->InitKeyboard();
+	game->Load(GYM_GAME_FILE);
+
+	if (sceneId > 0 && sceneId != game->GetCurrentSceneId())
+		game->SwitchScene(sceneId);
+	scene = dynamic_cast<CPlayScene*>(game->GetCurrentScene());
+	if (scene == NULL || scene->GetPlayer() == NULL || (sceneId > 0 && game->GetCurrentSceneId() != sceneId))
+	{
+		DebugOut(L"[ERROR] Scene %d is not a play scene of the game file\n", sceneId);
+		return false;
+	}
+
+	sceneId = game->GetCurrentSceneId();
+	startBackUp = world->backUp;
+	scene->SaveSnapshot(start);
+	return true;
+}
+
+void CGymEnv::SetKeys(DWORD action)
+{
+	for (size_t i = 0; i < sizeof(gymKeys) / sizeof(gymKeys[0]); i++)
+		keyboard->SetKey(gymKeys[i].keyCode, (action & gymKeys[i].action) != 0);
+}
+
+void CGymEnv::Reset(smb3_gym_observation& o)
+{
+	world->MakeCurrent();
+	CGame* game = &world->game;
+
+	// keys are let go without events, as if nothing had been held
+	*keyboard = CScriptedKeyboard();
+
+	if (game->GetCurrentScene() != scene || !scene->RestoreSnapshot(start))
+	{
+		start.Clear();
+		game->SwitchScene(sceneId);
+		scene = (CPlayScene*)game->GetCurrentScene();
+
+		// the scene loaded Mario with what the episode left him, he starts over
+		world->backUp = startBackUp;
+		startBackUp.LoadBackUpMario(scene->GetPlayer());
+		scene->SaveSnapshot(start);
+	}
+
+	episodeSteps = 0;
+	Observe(o);
+}
+
+/*
+	Hold the keys of the action for actionRepeat simulation steps. The episode ends when
+	Mario dies, takes the course card or falls off the map (which leaves the scene), the
+	env is then reset and o is the first observation of the next one
+*/
+void CGymEnv::Step(DWORD action, smb3_gym_observation& o, smb3_gym_result& r)
+{
+	world->MakeCurrent();
+	CGame* game = &world->game;
+	SetKeys(action);
+
+	CMario* mario = scene->GetPlayer();
+	float x0 = mario->x;
+	int points0 = mario->GetPoints();
+	bool left = false;
+
+	for (int i = 0; i < actionRepeat; i++)
+	{
+		game->SaveCamPos();
+		game->ProcessKeyboard();
+		scene->AdvanceClock(SIMULATION_STEP);
+		scene->Update(SIMULATION_STEP);
+
+		if (game->GetCurrentScene() != scene || scene->GetPlayer() == NULL)
+		{
+			left = true;
+			break;
+		}
+		if (mario->GetState() == MARIO_STATE_DIE || scene->GetNoti() != NULL)
+			break;
+	}
+	episodeSteps++;
+
+	memset(&r, 0, sizeof(r));
+	r.episode_steps = episodeSteps;
+	if (left)
+		r.died = 1;
+	else
+	{
+		r.distance = mario->x - x0;
+		r.points = mario->GetPoints() - points0;
+		r.died = mario->GetState() == MARIO_STATE_DIE;
+		r.cleared = scene->GetNoti() != NULL;
+	}
+	r.truncated = !r.died && !r.cleared && maxEpisodeSteps > 0 && episodeSteps >= maxEpisodeSteps;
+	r.done = r.died || r.cleared || r.truncated;
+
+	if (r.done)
+		Reset(o);
+	else
+		Observe(o);
+}
+
+/*
+	What a bot sees: the collision flags of the tiles around Mario, the objects in that
+	window (the terrain is left to the tiles), and Mario himself
+*/
+void CGymEnv::Observe(smb3_gym_observation& o)
+{
+	CMario* mario = scene->GetPlayer();
+	Map* map = scene->GetMap();
+	float cx = (mario->bbox_l + mario->bbox_r) / 2;
+	float cy = (mario->bbox_t + mario->bbox_b) / 2;
+
+	int tw = map->GetTileWidth(), th = map->GetTileHeight();
+	int firstCol = (int)floor(cx / tw) - SMB3_GYM_TILE_COLS / 2;
+	int firstRow = (int)floor(cy / th) - SMB3_GYM_TILE_ROWS / 2;
+	map->GetCollisionWindow(firstRow, firstCol, SMB3_GYM_TILE_ROWS, SMB3_GYM_TILE_COLS, &o.tiles[0][0]);
+
+	float l = (float)(firstCol * tw), t = (float)(firstRow * th);
+	float r = l + SMB3_GYM_TILE_COLS * tw, b = t + SMB3_GYM_TILE_ROWS * th;
+	nearby.clear();
+	CObjectHeap* heap = &world->heap;
+	for (CHeapBlock* block = heap->GetFirst(); !heap->IsEnd(block); block = block->next)
+	{
+		if (block->dead || block->cached || block->type != HEAP_BLOCK_GAME_OBJECT) continue;
+
+		LPGAMEOBJECT obj = (LPGAMEOBJECT)block->GetObject();
+		if (obj == mario || !obj->IsEnable) continue;
+		if (obj->kind == OBJECT_KIND_UNKNOWN || obj->kind == OBJECT_KIND_BRICK) continue;
+		if (obj->x < l || obj->x >= r || obj->y < t || obj->y >= b) continue;
+
+		float dx = obj->x - mario->x, dy = obj->y - mario->y;
+		nearby.push_back(make_pair(dx * dx + dy * dy, obj));
+	}
+	size_t n = min(nearby.size(), (size_t)SMB3_GYM_MAX_ENTITIES);
+	partial_sort(nearby.begin(), nearby.begin() + n, nearby.end(),
+		[](const pair<float, LPGAMEOBJECT>& a, const pair<float, LPGAMEOBJECT>& b) { return a.first < b.first; });
+
+	o.entity_count = (int32_t)n;
+	for (size_t i = 0; i < n; i++)
+	{
+		LPGAMEOBJECT obj = nearby[i].second;
+		smb3_gym_entity& e = o.entities[i];
+		e.kind = obj->kind;
+		e.state = obj->state;
+		e.dx = obj->x - mario->x;
+		e.dy = obj->y - mario->y;
+		e.vx = obj->vx;
+		e.vy = obj->vy;
+	}
+	memset(&o.entities[n], 0, (SMB3_GYM_MAX_ENTITIES - n) * sizeof(smb3_gym_entity));
+
+	o.x = mario->x;
+	o.y = mario->y;
+	o.vx = mario->vx;
+	o.vy = mario->vy;
+	o.state = mario->GetState();
+	o.level = mario->GetLevel();
+	o.nx = mario->nx;
+	o.on_ground = mario->IsTouchingGround;
+	o.remain_time = (int32_t)scene->GetRemainTime();
+}
+
+CGymBatch::~CGymBatch()
+{
+	for (size_t i = 0; i < envs.size(); i++)
+		delete envs[i];
+}
+
+bool CGymBatch::Load(const smb3_gym_config& config)
+{
+	for (int i = 0; i < config.envs; i++)
+		envs.push_back(new CGymEnv(config.scene, config.action_repeat, config.max_episode_steps));
+
+	vector<char> loaded(envs.size());
+	pool.ParallelFor((int)envs.size(), [&](int i) { loaded[i] = envs[i]->Load(); });
+	for (size_t i = 0; i < loaded.size(); i++)
+		if (!loaded[i])
+			return false;
+	return true;
+}
+
+void CGymBatch::Reset(smb3_gym_observation* observations)
+{
+	pool.ParallelFor((int)envs.size(), [&](int i) { envs[i]->Reset(observations[i]); });
+}
+
+void CGymBatch::Step(const DWORD* actions, smb3_gym_observation* observations, smb3_gym_result* results)
+{
+	pool.ParallelFor((int)envs.size(), [&](int i) { envs[i]->Step(actions[i], observations[i], results[i]); });
+}
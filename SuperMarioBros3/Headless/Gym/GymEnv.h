@@ -0,0 +1,77 @@
+#pragma once
+#include <vector>
+#include "smb3_gym.h"
+#include "ThreadPool.h"
+#include "../ScriptedKeyboard.h"
+#include "../../World.h"
+#include "../../Snapshot.h"
+#include "../../PlayScence.h"
+
+using namespace std;
+
+#define GYM_GAME_FILE	L"globalData\\mario-sample.txt"
+
+#define GYM_SCREEN_WIDTH	270
+#define GYM_SCREEN_HEIGHT	250
+
+/*
+	One environment: a world of its own, running one play scene with the keys the actions
+	hold down. Every call works on the env's world, whatever thread it is made on, but only
+	one thread at a time may use an env.
+
+	A new episode goes back to a snapshot of the scene as it was first loaded, unless the
+	scene was left (Mario fell off the map), then the scene is loaded again.
+*/
+class CGymEnv
+{
+	CWorld* world = NULL;
+	CScriptedKeyboard* keyboard = NULL;		// owned by the world's game
+	CPlayScene* scene = NULL;
+	int sceneId;
+	int actionRepeat;
+	int maxEpisodeSteps;
+
+	CSnapshot start;
+	CBackUp startBackUp;		// Mario's counters of the first load, for the loads after it
+	int episodeSteps = 0;
+
+	vector<pair<float, LPGAMEOBJECT>> nearby;	// scratch of Observe
+
+	void SetKeys(DWORD action);
+	void Observe(smb3_gym_observation& o);
+
+public:
+	CGymEnv(int sceneId, int actionRepeat, int maxEpisodeSteps);
+	~CGymEnv();
+
+	// false when the game file cannot be loaded or the scene is not a play scene
+	bool Load();
+
+	void Reset(smb3_gym_observation& o);
+	void Step(DWORD action, smb3_gym_observation& o, smb3_gym_result& r);
+
+	int GetSceneId() { return sceneId; }
+};
+typedef CGymEnv * LPGYMENV;
+
+/*
+	Environments stepped together, spread over a thread pool
+*/
+class CGymBatch
+{
+	CThreadPool pool;
+	vector<LPGYMENV> envs;
+
+public:
+	CGymBatch(int threads) : pool(threads) {}
+	~CGymBatch();
+
+	// false when any of the environments cannot load
+	bool Load(const smb3_gym_config& config);
+
+	int GetEnvCount() { return (int)envs.size(); }
+	int GetThreadCount() { return pool.GetThreadCount(); }
+
+	void Reset(smb3_gym_observation* observations);
+	void Step(const DWORD* actions, smb3_gym_observation* observations, smb3_gym_result* results);
+};
@@ -0,0 +1,78 @@
+#include "ThreadPool.h"
+
+CThreadPool::CThreadPool(int threads)
+{
+	if (threads <= 0)
+		threads = max((int)thread::hardware_concurrency(), 1);
+
+	next = 0;
+	for (int i = 1; i < threads; i++)
+		workers.push_back(thread(&CThreadPool::WorkerLoop, this));
+}
+
+CThreadPool::~CThreadPool()
+{
+	{
+		unique_lock<mutex> l(lock);
+		closing = true;
+	}
+	wake.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+void CThreadPool::RunIterations(const function<void(int)>& f, int count)
+{
+	for (int i = next++; i < count; i = next++)
+		f(i);
+}
+
+void CThreadPool::WorkerLoop()
+{
+	unsigned int lastJob = 0;
+	unique_lock<mutex> l(lock);
+	for (;;)
+	{
+		wake.wait(l, [&] { return closing || (job != NULL && jobId != lastJob); });
+		if (closing)
+			return;
+
+		lastJob = jobId;
+		const function<void(int)>* f = job;
+		int count = jobCount;
+		busyWorkers++;
+
+		l.unlock();
+		RunIterations(*f, count);
+		l.lock();
+
+		if (--busyWorkers == 0)
+			finished.notify_all();
+	}
+}
+
+void CThreadPool::ParallelFor(int count, const function<void(int)>& f)
+{
+	if (workers.empty() || count <= 1)
+	{
+		for (int i = 0; i < count; i++)
+			f(i);
+		return;
+	}
+
+	{
+		unique_lock<mutex> l(lock);
+		job = &f;
+		jobCount = count;
+		jobId++;
+		next = 0;
+	}
+	wake.notify_all();
+
+	RunIterations(f, count);
+
+	// the job is over once every iteration was taken and no worker is still running one
+	unique_lock<mutex> l(lock);
+	job = NULL;
+	finished.wait(l, [&] { return busyWorkers == 0; });
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*
+	Fixed set of threads running the iterations of a parallel for. The calling thread takes
+	iterations too, so a pool of one thread runs everything on the caller
+*/
+class CThreadPool
+{
+	vector<thread> workers;
+
+	mutex lock;
+	condition_variable wake;		// a new job is up, or the pool is closing
+	condition_variable finished;	// the last worker left the job
+	bool closing = false;
+
+	// the job being run
+	const function<void(int)>* job = NULL;
+	int jobCount = 0;
+	unsigned int jobId = 0;			// changes with every job, so a worker takes each one once
+	atomic<int> next;				// next iteration to take
+	int busyWorkers = 0;
+
+	void WorkerLoop();
+	void RunIterations(const function<void(int)>& f, int count);
+
+public:
+	// threads 0 for one per core
+	CThreadPool(int threads);
+	~CThreadPool();
+
+	int GetThreadCount() { return (int)workers.size() + 1; }
+
+	// runs f(0) to f(count - 1) and returns when they are all done
+	void ParallelFor(int count, const function<void(int)>& f);
+};
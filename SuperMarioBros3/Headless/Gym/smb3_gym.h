@@ -0,0 +1,108 @@
+#pragma once
+/* =============================================================
+	SMB3 GYM, C INTERFACE
+
+	A batch of headless play scenes stepped together for bots: every step takes one action
+	bitmask per environment and gives back an observation and the reward signals of each.
+	The environments are stepped in parallel on a thread pool.
+
+		smb3_gym_config config = { 0 };
+		config.envs = 64;
+		smb3_gym* gym = smb3_gym_create(&config);
+		smb3_gym_reset(gym, observations);
+		for (;;) smb3_gym_step(gym, actions, observations, results);
+		smb3_gym_destroy(gym);
+
+	An environment whose episode ended (see smb3_gym_result) is reset by the step that
+	ended it, the observation it returns is the first of the next episode.
+
+	The game reads its files relative to the data folder, creating a gym makes it the
+	working directory of the process.
+
+================================================================ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* action bits, the keys of the keyboard they hold down */
+#define SMB3_GYM_LEFT		(1u << 0)	/* LEFT */
+#define SMB3_GYM_RIGHT		(1u << 1)	/* RIGHT */
+#define SMB3_GYM_UP			(1u << 2)	/* UP */
+#define SMB3_GYM_DOWN		(1u << 3)	/* DOWN */
+#define SMB3_GYM_JUMP		(1u << 4)	/* S */
+#define SMB3_GYM_RUN		(1u << 5)	/* A, also fires and swings the tail */
+
+/* tile window around Mario, in tiles of the map */
+#define SMB3_GYM_TILE_ROWS		14
+#define SMB3_GYM_TILE_COLS		16
+
+#define SMB3_GYM_MAX_ENTITIES	16
+
+typedef struct smb3_gym_config
+{
+	const char* data_dir;		/* game folder, NULL for the one the library was built from */
+	int scene;					/* play scene to run, 0 for the start scene of the game file */
+	int envs;					/* environments in the batch */
+	int threads;				/* 0 for one per core */
+	int action_repeat;			/* simulation steps per gym step, 0 for 1 */
+	int max_episode_steps;		/* gym steps before an episode is cut short, 0 for no limit */
+} smb3_gym_config;
+
+typedef struct smb3_gym_entity
+{
+	int32_t kind;				/* OBJECT_KIND_ of the object */
+	int32_t state;
+	float dx, dy;				/* position relative to Mario */
+	float vx, vy;
+} smb3_gym_entity;
+
+typedef struct smb3_gym_observation
+{
+	/* TILE_COLLISION_ flags, Mario's tile at row SMB3_GYM_TILE_ROWS / 2, col SMB3_GYM_TILE_COLS / 2 */
+	uint8_t tiles[SMB3_GYM_TILE_ROWS][SMB3_GYM_TILE_COLS];
+
+	/* objects of the tile window, nearest first */
+	int32_t entity_count;
+	smb3_gym_entity entities[SMB3_GYM_MAX_ENTITIES];
+
+	float x, y;
+	float vx, vy;
+	int32_t state;				/* MARIO_STATE_ */
+	int32_t level;				/* MARIO_LEVEL_ */
+	int32_t nx;					/* facing, -1 left, 1 right */
+	int32_t on_ground;
+	int32_t remain_time;		/* ms on the course clock */
+} smb3_gym_observation;
+
+typedef struct smb3_gym_result
+{
+	float distance;				/* Mario's move to the right over the step, in pixels */
+	int32_t points;				/* points scored over the step */
+	int32_t died;				/* the episode ended with Mario dead or fallen off the map */
+	int32_t cleared;			/* the episode ended with the course card taken */
+	int32_t truncated;			/* the episode reached max_episode_steps */
+	int32_t done;				/* any of the three, the environment was reset */
+	int32_t episode_steps;		/* gym steps of the episode, counting this one */
+} smb3_gym_result;
+
+typedef struct smb3_gym smb3_gym;
+
+/* NULL when the game files cannot be loaded or the scene is not a play scene */
+smb3_gym* smb3_gym_create(const smb3_gym_config* config);
+void smb3_gym_destroy(smb3_gym* gym);
+
+int smb3_gym_env_count(smb3_gym* gym);
+
+/* starts a new episode in every environment, observations holds one per environment */
+void smb3_gym_reset(smb3_gym* gym, smb3_gym_observation* observations);
+
+/* actions, observations and results hold one per environment */
+void smb3_gym_step(smb3_gym* gym, const uint32_t* actions,
+	smb3_gym_observation* observations, smb3_gym_result* results);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,826 @@
+/* =============================================================
+	HEADLESS SIMULATION RUNNER
+
+	Runs the game without a window, GPU or keyboard, for perf testing the simulation on
+	build servers:
+
+		1/ Load globalData/mario-sample.txt and switch to the chosen scene
+		2/ Feed the keys of an input script (or the built-in one, or a recorded input log)
+		   frame by frame
+		3/ Run N frames of one simulation step each as fast as possible, rendering to the
+		   null renderer (or the software one), and print frame-time percentiles and
+		   objects-updated counts
+
+	usage: smb3_headless [--scene id] [--frames n] [--input script.txt] [--data dir]
+	                     [--record log] [--replay log] [--rollback frame]
+	                     [--hash-log file] [--hash-check file] [--render-every k]
+	                     [--no-render] [--no-batch] [--no-atlas]
+	                     [--chunk-budget kb] [--software] [--scale k]
+	                     [--golden-write dir] [--golden-check dir] [--golden-diff dir]
+	                     [--golden-frames list] [--tolerance n] [--verbose]
+
+	--record writes the keys of the run to an input log, --replay plays one back (from the
+	scene it was recorded in and for all its steps, unless --scene or --frames say otherwise)
+
+	--hash-log writes the state hash of the play scene after every frame (see
+	CPlayScene::HashState), --hash-check compares the run against such a file and reports the
+	first frame that differs. Run the same input through the reference build with --hash-log
+	and through the changed one with --hash-check to find where their behavior diverges. The
+	scenes hash their state only for these two and for --rollback
+
+	--render-every renders only every k-th frame (--no-render none), the steps in between run
+	back to back like the turbo mode of the game. The frames go through CBatchRenderer, which
+	--no-batch turns off to compare the texture switches. --no-atlas leaves the sprites on
+	their own sheets instead of packing them into atlases when a scene loads (see CAtlasPacker)
+
+	--chunk-budget sets the memory the map keeps for its chunk textures (see CMapChunkCache),
+	0 draws the map tile by tile
+
+	--software draws the frames for real, on the CPU into a frame buffer (see
+	CSoftwareRenderer), --scale scales that up k times. Only when built with libpng
+
+	--golden-write saves the frames of the software renderer at the frames of --golden-frames
+	(a comma separated list, every 300th by default) as PNGs, --golden-check compares them
+	against the saved ones, a channel off by more than --tolerance is a difference (see
+	CGoldenFrames). --golden-diff saves an image of each frame that differs, the goldens
+	stay as they are. Both draw with the software renderer. Run the same input through the
+	reference build with --golden-write and through the changed one with --golden-check, or
+	with --no-batch --no-atlas --chunk-budget 0 and then without, to check a change of the
+	render path leaves the frames as they were. Keep --render-every the same for both: the
+	animations step at most one frame per frame drawn
+
+	Headless/Tests/Golden keeps recorded input logs with their golden frames, ctest replays
+	them through the default render path and checks the frames
+
+	--rollback takes a snapshot of the play scene before the given frame, restores it at the
+	end of the run and runs the rest again, checking it plays out the same
+
+================================================================ */
+
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <limits.h>
+
+#include <Windows.h>
+
+#include "../Utils.h"
+#include "../World.h"
+#include "../InputLog.h"
+#include "../PlayScence.h"
+#include "../WorldMap.h"
+#include "../Textures.h"
+#include "../Snapshot.h"
+#include "../StateHash.h"
+#include "../BatchRenderer.h"
+#include "NullRenderer.h"
+#ifdef SMB3_SOFTWARE_RENDERER
+#include "SoftwareRenderer.h"
+#include "GoldenFrames.h"
+#include "Blit.h"
+#endif
+#include "ScriptedKeyboard.h"
+
+#define HEADLESS_SCREEN_WIDTH	270
+#define HEADLESS_SCREEN_HEIGHT	250
+#define HEADLESS_DEFAULT_FRAMES	3600
+
+#define BACKGROUND_COLOR COLOR_XRGB(0,0,0)
+
+#define GAME_FILE L"globalData\\mario-sample.txt"
+
+#define MAX_SCRIPT_LINE 1024
+
+struct CScriptedKey
+{
+	int frame;
+	int keyCode;
+	bool down;
+};
+
+// what a frame left behind, compared between the run and its rerun from a snapshot
+struct CFrameCheck
+{
+	int scene;
+	int updated;
+	float x, y;		// Mario
+	ULONGLONG hash;	// of the play scene, 0 in other scenes
+};
+
+struct CKeyName
+{
+	const char* name;
+	int keyCode;
+};
+
+static const CKeyName keyNames[] =
+{
+	{ "LEFT", DIK_LEFT }, { "RIGHT", DIK_RIGHT }, { "UP", DIK_UP }, { "DOWN", DIK_DOWN },
+	{ "A", DIK_A }, { "S", DIK_S }, { "Q", DIK_Q }, { "W", DIK_W }, { "Z", DIK_Z },
+	{ "T", DIK_T }, { "SPACE", DIK_SPACE },
+};
+
+int FindKeyCode(string name)
+{
+	for (size_t i = 0; i < sizeof(keyNames) / sizeof(keyNames[0]); i++)
+		if (name == keyNames[i].name)
+			return keyNames[i].keyCode;
+	return -1;
+}
+
+/*
+	Input script: one "frame key state" line per key change, state 1 presses the key and 0
+	releases it. Lines starting with # are comments
+*/
+bool LoadInputScript(const char* path, vector<CScriptedKey>& script)
+{
+	ifstream f(path);
+	if (!f)
+	{
+		fprintf(stderr, "[ERROR] Cannot open input script %s\n", path);
+		return false;
+	}
+
+	char str[MAX_SCRIPT_LINE];
+	int lineNumber = 0;
+	while (f.getline(str, MAX_SCRIPT_LINE))
+	{
+		lineNumber++;
+		string line(str);
+		if (line.empty() || line[0] == '#') continue;
+
+		vector<string> tokens = split(line);
+		if (tokens.size() < 3) continue;
+
+		CScriptedKey key;
+		key.frame = atoi(tokens[0].c_str());
+		key.keyCode = FindKeyCode(tokens[1]);
+		key.down = atoi(tokens[2].c_str()) != 0;
+		if (key.keyCode < 0)
+		{
+			fprintf(stderr, "[ERROR] Unknown key %s at line %d of %s\n", tokens[1].c_str(), lineNumber, path);
+			return false;
+		}
+		script.push_back(key);
+	}
+
+	stable_sort(script.begin(), script.end(),
+		[](const CScriptedKey& a, const CScriptedKey& b) { return a.frame < b.frame; });
+	return true;
+}
+
+/*
+	Built-in script: a run through World 1-1, found by trying jump timings against the game.
+	Mario jumps onto the platforms to get over the first pipe, takes the mushroom of a
+	question block at frame 557 and loses it to an enemy at 693, and keeps making his way
+	right for all of the 3600 frames of the default run, the camera scrolling to x 1925. The
+	last key is at frame 4029: Mario then walks past the goal card, which small Mario jumps
+	too low to touch, and off the end of the map at frame 4687
+*/
+static const CScriptedKey defaultScript[] =
+{
+	{ 10, DIK_RIGHT, true }, { 140, DIK_S, true }, { 159, DIK_S, false }, { 200, DIK_S, true },
+	{ 219, DIK_S, false }, { 220, DIK_RIGHT, false }, { 220, DIK_LEFT, true }, { 250, DIK_LEFT, false },
+	{ 250, DIK_RIGHT, true }, { 250, DIK_S, true }, { 279, DIK_S, false }, { 310, DIK_RIGHT, false },
+	{ 310, DIK_LEFT, true }, { 310, DIK_S, true }, { 339, DIK_S, false }, { 340, DIK_LEFT, false },
+	{ 340, DIK_RIGHT, true }, { 370, DIK_RIGHT, false }, { 400, DIK_RIGHT, true }, { 430, DIK_S, true },
+	{ 434, DIK_S, false }, { 470, DIK_S, true }, { 489, DIK_S, false }, { 520, DIK_RIGHT, false },
+	{ 520, DIK_LEFT, true }, { 530, DIK_S, true }, { 549, DIK_S, false }, { 550, DIK_LEFT, false },
+	{ 580, DIK_RIGHT, true }, { 650, DIK_S, true }, { 669, DIK_S, false }, { 880, DIK_S, true },
+	{ 909, DIK_S, false }, { 940, DIK_RIGHT, false }, { 940, DIK_S, true }, { 969, DIK_S, false },
+	{ 970, DIK_RIGHT, true }, { 1000, DIK_S, true }, { 1029, DIK_S, false }, { 1220, DIK_S, true },
+	{ 1239, DIK_S, false }, { 1290, DIK_S, true }, { 1299, DIK_S, false }, { 1420, DIK_RIGHT, false },
+	{ 1420, DIK_LEFT, true }, { 1440, DIK_S, true }, { 1449, DIK_S, false }, { 1450, DIK_LEFT, false },
+	{ 1450, DIK_RIGHT, true }, { 1480, DIK_RIGHT, false }, { 1510, DIK_RIGHT, true }, { 1540, DIK_RIGHT, false },
+	{ 1570, DIK_RIGHT, true }, { 1630, DIK_RIGHT, false }, { 1630, DIK_LEFT, true }, { 1660, DIK_LEFT, false },
+	{ 1660, DIK_RIGHT, true }, { 1670, DIK_S, true }, { 1689, DIK_S, false }, { 1720, DIK_RIGHT, false },
+	{ 1780, DIK_RIGHT, true }, { 1810, DIK_RIGHT, false }, { 1810, DIK_LEFT, true }, { 1840, DIK_LEFT, false },
+	{ 1840, DIK_RIGHT, true }, { 1910, DIK_S, true }, { 1929, DIK_S, false }, { 2110, DIK_S, true },
+	{ 2139, DIK_S, false }, { 2170, DIK_RIGHT, false }, { 2170, DIK_S, true }, { 2199, DIK_S, false },
+	{ 2200, DIK_RIGHT, true }, { 2230, DIK_RIGHT, false }, { 2260, DIK_RIGHT, true }, { 2290, DIK_S, true },
+	{ 2319, DIK_S, false }, { 2350, DIK_RIGHT, false }, { 2350, DIK_S, true }, { 2379, DIK_S, false },
+	{ 2380, DIK_RIGHT, true }, { 2460, DIK_S, true }, { 2469, DIK_S, false }, { 2510, DIK_S, true },
+	{ 2529, DIK_S, false }, { 2560, DIK_S, true }, { 2589, DIK_S, false }, { 2590, DIK_RIGHT, false },
+	{ 2650, DIK_RIGHT, true }, { 2680, DIK_S, true }, { 2709, DIK_S, false }, { 2830, DIK_RIGHT, false },
+	{ 2860, DIK_RIGHT, true }, { 2900, DIK_S, true }, { 2919, DIK_S, false }, { 2920, DIK_RIGHT, false },
+	{ 2960, DIK_S, true }, { 2979, DIK_S, false }, { 3010, DIK_RIGHT, true }, { 3020, DIK_S, true },
+	{ 3039, DIK_S, false }, { 3070, DIK_RIGHT, false }, { 3070, DIK_LEFT, true }, { 3100, DIK_LEFT, false },
+	{ 3100, DIK_RIGHT, true }, { 3130, DIK_S, true }, { 3159, DIK_S, false }, { 3190, DIK_RIGHT, false },
+	{ 3220, DIK_RIGHT, true }, { 3280, DIK_S, true }, { 3309, DIK_S, false }, { 3340, DIK_RIGHT, false },
+	{ 3340, DIK_S, true }, { 3369, DIK_S, false }, { 3370, DIK_RIGHT, true }, { 3400, DIK_RIGHT, false },
+	{ 3430, DIK_RIGHT, true }, { 3460, DIK_RIGHT, false }, { 3460, DIK_LEFT, true }, { 3490, DIK_LEFT, false },
+	{ 3490, DIK_RIGHT, true }, { 3520, DIK_RIGHT, false }, { 3550, DIK_RIGHT, true }, { 3580, DIK_S, true },
+	{ 3609, DIK_S, false }, { 3670, DIK_RIGHT, false }, { 3670, DIK_LEFT, true }, { 3700, DIK_LEFT, false },
+	{ 3700, DIK_RIGHT, true }, { 3710, DIK_S, true }, { 3729, DIK_S, false }, { 3830, DIK_S, true },
+	{ 3849, DIK_S, false }, { 3880, DIK_RIGHT, false }, { 3900, DIK_S, true }, { 3909, DIK_S, false },
+	{ 3910, DIK_RIGHT, true }, { 4000, DIK_S, true }, { 4029, DIK_S, false },
+};
+
+void MakeDefaultScript(int frames, vector<CScriptedKey>& script)
+{
+	for (size_t i = 0; i < sizeof(defaultScript) / sizeof(defaultScript[0]); i++)
+		if (defaultScript[i].frame < frames)
+			script.push_back(defaultScript[i]);
+}
+
+double renderTime = 0;		// us, of all the frames rendered
+
+/*
+	Same frame as Render in main.cpp, without the camera interpolation: every frame here is
+	exactly one simulation step
+*/
+void Render(CGame* game)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	LPRENDERER renderer = game->GetRenderer();
+	renderer->BeginFrame(BACKGROUND_COLOR);
+	game->GetCurrentScene()->Render();
+	renderer->EndFrame();
+	renderTime += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+}
+
+/*
+	One simulation step, with its frame when rendering
+*/
+CFrameCheck Step(CGame* game, bool render)
+{
+	game->SaveCamPos();
+	game->ProcessKeyboard();
+
+	CFrameCheck c = { game->GetCurrentSceneId(), 0, 0, 0, 0 };
+	LPSCENE scene = game->GetCurrentScene();
+	scene->AdvanceClock(SIMULATION_STEP);
+	scene->Update(SIMULATION_STEP);
+
+	if (render)
+		Render(game);
+
+	// read the scene that ran the step, Update may have switched to another one
+	c.updated = scene->GetUpdatedObjects();
+	CPlayScene* playScene = dynamic_cast<CPlayScene*>(scene);
+	if (playScene != NULL && playScene->GetPlayer() != NULL)
+	{
+		playScene->GetPlayer()->GetPosition(c.x, c.y);
+		c.hash = playScene->GetStateHash();
+	}
+	return c;
+}
+
+/*
+	Map of a play scene or of the world map, NULL for the other scenes
+*/
+Map* SceneMap(LPSCENE scene)
+{
+	CPlayScene* playScene = dynamic_cast<CPlayScene*>(scene);
+	if (playScene != NULL)
+		return playScene->GetMap();
+	CWorldMap* worldMap = dynamic_cast<CWorldMap*>(scene);
+	if (worldMap != NULL)
+		return worldMap->GetMap();
+	return NULL;
+}
+
+bool SameFrame(const CFrameCheck& a, const CFrameCheck& b)
+{
+	return a.scene == b.scene && a.updated == b.updated && a.x == b.x && a.y == b.y && a.hash == b.hash;
+}
+
+/*
+	Hash file: one "frame scene hash" line per frame, the hash in hex
+*/
+bool LoadHashFile(const char* path, vector<CFrameCheck>& hashes)
+{
+	FILE* f = fopen(path, "r");
+	if (f == NULL)
+	{
+		fprintf(stderr, "[ERROR] Cannot open hash file %s\n", path);
+		return false;
+	}
+
+	int frame, scene;
+	unsigned long long hash;
+	while (fscanf(f, "%d %d %llx", &frame, &scene, &hash) == 3)
+	{
+		if (frame != (int)hashes.size())
+		{
+			fprintf(stderr, "[ERROR] Frame %d of %s is out of order\n", frame, path);
+			fclose(f);
+			return false;
+		}
+		CFrameCheck c = { scene, 0, 0, 0, (ULONGLONG)hash };
+		hashes.push_back(c);
+	}
+	fclose(f);
+	return true;
+}
+
+double Percentile(const vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+	size_t i = (size_t)(p * sorted.size());
+	if (i >= sorted.size())
+		i = sorted.size() - 1;
+	return sorted[i];
+}
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: smb3_headless [--scene id] [--frames n] [--input script.txt] [--data dir]\n"
+		"                     [--record log] [--replay log] [--rollback frame]\n"
+		"                     [--hash-log file] [--hash-check file] [--render-every k]\n"
+		"                     [--no-render] [--no-batch] [--no-atlas]\n"
+		"                     [--chunk-budget kb] [--software] [--scale k]\n"
+		"                     [--golden-write dir] [--golden-check dir] [--golden-diff dir]\n"
+		"                     [--golden-frames list] [--tolerance n] [--verbose]\n");
+}
+
+/*
+	Paths given on the command line are relative to where the runner was started, not to the
+	data folder it works in
+*/
+string AbsolutePath(const char* path)
+{
+	string full(path);
+	char cwd[PATH_MAX];
+	if (full[0] != '/' && getcwd(cwd, sizeof(cwd)) != NULL)
+		full = string(cwd) + "/" + full;
+	return full;
+}
+
+wstring CommandLinePath(const char* path)
+{
+	return ToWSTR(AbsolutePath(path));
+}
+
+/*
+	Frames of --golden-frames, comma separated
+*/
+bool ParseFrameList(const char* list, vector<int>& frames)
+{
+	vector<string> tokens = split(list, ",");
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		char* end;
+		long frame = strtol(tokens[i].c_str(), &end, 10);
+		if (tokens[i].empty() || *end != 0 || frame < 0)
+		{
+			fprintf(stderr, "[ERROR] Invalid frame '%s' in --golden-frames\n", tokens[i].c_str());
+			return false;
+		}
+		frames.push_back((int)frame);
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	int sceneId = -1;
+	int frames = -1;
+	const char* inputPath = NULL;
+	const char* recordPath = NULL;
+	const char* replayPath = NULL;
+	int rollbackFrame = -1;
+	const char* hashLogPath = NULL;
+	const char* hashCheckPath = NULL;
+	const char* dataDir = SMB3_DATA_DIR;
+	int renderEvery = 1;
+	bool batch = true;
+	bool atlas = true;
+	int chunkBudget = MAP_CHUNK_CACHE_BUDGET / 1024;
+	bool software = false;
+	int scale = 1;
+	const char* goldenWritePath = NULL;
+	const char* goldenCheckPath = NULL;
+	const char* goldenDiffPath = NULL;
+	const char* goldenFramesList = NULL;
+	int tolerance = 0;
+	bool verbose = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if (arg == "--scene" && hasValue) sceneId = atoi(argv[++i]);
+		else if (arg == "--frames" && hasValue) frames = atoi(argv[++i]);
+		else if (arg == "--input" && hasValue) inputPath = argv[++i];
+		else if (arg == "--data" && hasValue) dataDir = argv[++i];
+		else if (arg == "--record" && hasValue) recordPath = argv[++i];
+		else if (arg == "--replay" && hasValue) replayPath = argv[++i];
+		else if (arg == "--rollback" && hasValue) rollbackFrame = atoi(argv[++i]);
+		else if (arg == "--hash-log" && hasValue) hashLogPath = argv[++i];
+		else if (arg == "--hash-check" && hasValue) hashCheckPath = argv[++i];
+		else if (arg == "--render-every" && hasValue) renderEvery = max(atoi(argv[++i]), 0);
+		else if (arg == "--no-render") renderEvery = 0;
+		else if (arg == "--no-batch") batch = false;
+		else if (arg == "--no-atlas") atlas = false;
+		else if (arg == "--chunk-budget" && hasValue) chunkBudget = max(atoi(argv[++i]), 0);
+		else if (arg == "--software") software = true;
+		else if (arg == "--scale" && hasValue) scale = max(atoi(argv[++i]), 1);
+		else if (arg == "--golden-write" && hasValue) goldenWritePath = argv[++i];
+		else if (arg == "--golden-check" && hasValue) goldenCheckPath = argv[++i];
+		else if (arg == "--golden-diff" && hasValue) goldenDiffPath = argv[++i];
+		else if (arg == "--golden-frames" && hasValue) goldenFramesList = argv[++i];
+		else if (arg == "--tolerance" && hasValue) tolerance = max(atoi(argv[++i]), 0);
+		else if (arg == "--verbose") verbose = true;
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+	}
+
+	HeadlessSetDebugOutput(verbose);
+
+	bool golden = goldenWritePath != NULL || goldenCheckPath != NULL;
+	if (golden)
+		software = true;
+#ifndef SMB3_SOFTWARE_RENDERER
+	if (software)
+	{
+		fprintf(stderr, "[ERROR] --software and the golden frames need a build with libpng\n");
+		return 2;
+	}
+#endif
+
+	// the rerun needs the keys of the script again, a log or a recording cannot rewind
+	if (rollbackFrame >= 0 && (replayPath != NULL || recordPath != NULL))
+	{
+		fprintf(stderr, "[ERROR] --rollback runs a script, not with --replay or --record\n");
+		return 2;
+	}
+
+	CScriptedKeyboard* keyboard = NULL;
+	CInputReplay* replay = NULL;
+	LPINPUT input;
+	vector<CScriptedKey> script;
+	if (replayPath != NULL)
+	{
+		replay = new CInputReplay();
+		if (!replay->Open(CommandLinePath(replayPath).c_str()))
+		{
+			fprintf(stderr, "[ERROR] Cannot replay input log %s\n", replayPath);
+			return 1;
+		}
+		if (sceneId == -1) sceneId = replay->GetSceneId();
+		if (frames < 0) frames = (int)replay->GetSteps();
+		input = replay;
+	}
+	else
+	{
+		if (frames < 0) frames = HEADLESS_DEFAULT_FRAMES;
+		if (inputPath != NULL)
+		{
+			if (!LoadInputScript(inputPath, script))
+				return 1;
+		}
+		else
+			MakeDefaultScript(frames, script);
+		keyboard = new CScriptedKeyboard();
+		input = keyboard;
+	}
+
+	CInputRecorder* recorder = NULL;
+	wstring recordFile;
+	if (recordPath != NULL)
+	{
+		recordFile = CommandLinePath(recordPath);
+		recorder = new CInputRecorder(input);
+		input = recorder;
+	}
+
+	// frames to take goldens of, every GOLDEN_DEFAULT_EVERY-th when no list is given
+	vector<bool> goldenFrames;
+#ifdef SMB3_SOFTWARE_RENDERER
+	CGoldenFrames* goldens = NULL;
+	if (golden)
+	{
+		goldenFrames.assign(frames, false);
+		vector<int> list;
+		if (goldenFramesList != NULL && !ParseFrameList(goldenFramesList, list))
+			return 2;
+		if (goldenFramesList == NULL)
+			for (int frame = GOLDEN_DEFAULT_EVERY - 1; frame < frames; frame += GOLDEN_DEFAULT_EVERY)
+				list.push_back(frame);
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			if (list[i] < frames)
+				goldenFrames[list[i]] = true;
+			else
+				printf("[WARNING] golden frame %d is past the last frame of the run\n", list[i]);
+		}
+
+		string writeDir, checkDir, diffDir;
+		if (goldenWritePath != NULL)
+		{
+			writeDir = AbsolutePath(goldenWritePath);
+			mkdir(writeDir.c_str(), 0777);
+		}
+		if (goldenCheckPath != NULL)
+			checkDir = AbsolutePath(goldenCheckPath);
+		if (goldenDiffPath != NULL)
+		{
+			diffDir = AbsolutePath(goldenDiffPath);
+			mkdir(diffDir.c_str(), 0777);
+		}
+		goldens = new CGoldenFrames(writeDir, checkDir, diffDir, tolerance);
+	}
+#endif
+
+	vector<CFrameCheck> referenceHashes;
+	if (hashCheckPath != NULL && !LoadHashFile(hashCheckPath, referenceHashes))
+		return 1;
+
+	FILE* hashLog = NULL;
+	if (hashLogPath != NULL)
+	{
+		hashLog = fopen(hashLogPath, "w");
+		if (hashLog == NULL)
+		{
+			fprintf(stderr, "[ERROR] Cannot create hash file %s\n", hashLogPath);
+			return 1;
+		}
+	}
+
+	// the scene files name their resources relative to the game folder
+	if (chdir(dataDir) != 0)
+	{
+		fprintf(stderr, "[ERROR] Cannot enter data folder %s\n", dataDir);
+		return 1;
+	}
+	ifstream gameFile;
+	OpenDataFile(gameFile, GAME_FILE);
+	if (!gameFile)
+	{
+		fprintf(stderr, "[ERROR] %s has no globalData/mario-sample.txt\n", dataDir);
+		return 1;
+	}
+	gameFile.close();
+
+	HeadlessSetClientSize(HEADLESS_SCREEN_WIDTH, HEADLESS_SCREEN_HEIGHT);
+
+	// the counters of whichever renderer draws
+	LPRENDERER renderer;
+	ULONGLONG* spritesDrawn;
+	int* texturesMissing;
+#ifdef SMB3_SOFTWARE_RENDERER
+	CSoftwareRenderer* softwareRenderer = NULL;
+	if (software)
+	{
+		softwareRenderer = new CSoftwareRenderer();
+		softwareRenderer->Init(NULL, HEADLESS_SCREEN_WIDTH, HEADLESS_SCREEN_HEIGHT);
+		softwareRenderer->SetScale(scale);
+		spritesDrawn = &softwareRenderer->spritesDrawn;
+		texturesMissing = &softwareRenderer->texturesMissing;
+		renderer = softwareRenderer;
+	}
+	else
+#endif
+	{
+		CNullRenderer* nullRenderer = new CNullRenderer();
+		spritesDrawn = &nullRenderer->spritesDrawn;
+		texturesMissing = &nullRenderer->texturesMissing;
+		renderer = nullRenderer;
+	}
+	CBatchRenderer* batchRenderer = new CBatchRenderer(renderer);
+	batchRenderer->SetEnabled(batch);
+
+	CWorld* world = new CWorld();
+	world->MakeCurrent();
+
+	CGame* game = &world->game;
+	game->Init(NULL, batchRenderer, input);
+	game->InitKeyboard();
+	game->SetPackAtlases(atlas);
+	game->SetMapChunkBudget((size_t)chunkBudget * 1024);
+	game->SetHashStates(hashLogPath != NULL || hashCheckPath != NULL || rollbackFrame >= 0);
+	game->Load(GAME_FILE);
+
+	if (sceneId != -1 && sceneId != game->GetCurrentSceneId())
+	{
+		game->SwitchScene(sceneId);
+		if (game->GetCurrentSceneId() != sceneId)
+		{
+			fprintf(stderr, "[ERROR] Scene %d is not in the game file\n", sceneId);
+			return 1;
+		}
+	}
+	int startScene = game->GetCurrentSceneId();
+	if (recorder != NULL && !recorder->Open(recordFile.c_str(), startScene))
+	{
+		fprintf(stderr, "[ERROR] Cannot create input log %s\n", recordPath);
+		return 1;
+	}
+	int missingTextures = *texturesMissing;
+
+	vector<double> frameTimes;
+	frameTimes.reserve(frames);
+	ULONGLONG objectsUpdated = 0;
+	int maxObjectsUpdated = 0;
+	ULONGLONG spritesBefore = *spritesDrawn;
+	int renderedFrames = 0;
+	size_t nextKey = 0;
+
+	CSnapshot snapshot;
+	CPlayScene* rollbackScene = NULL;
+	CScriptedKeyboard rollbackKeys;
+	size_t rollbackNextKey = 0;
+	double saveTime = 0;
+	vector<CFrameCheck> checks;
+	int hashMismatch = -1;
+	CFrameCheck hashFound = {}, hashExpected = {};
+
+	chrono::steady_clock::time_point runStart = chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		if (frame == rollbackFrame)
+		{
+			rollbackScene = dynamic_cast<CPlayScene*>(game->GetCurrentScene());
+			if (rollbackScene != NULL)
+			{
+				chrono::steady_clock::time_point saveStart = chrono::steady_clock::now();
+				rollbackScene->SaveSnapshot(snapshot);
+				saveTime = chrono::duration<double, micro>(chrono::steady_clock::now() - saveStart).count();
+				rollbackKeys = *keyboard;
+				rollbackNextKey = nextKey;
+			}
+		}
+
+		if (keyboard != NULL)
+			for (; nextKey < script.size() && script[nextKey].frame <= frame; nextKey++)
+				keyboard->SetKey(script[nextKey].keyCode, script[nextKey].down);
+
+		chrono::steady_clock::time_point frameStart = chrono::steady_clock::now();
+
+		// a golden frame is drawn whatever --render-every says
+		bool goldenFrame = !goldenFrames.empty() && goldenFrames[frame];
+		bool render = (renderEvery > 0 && (frame + 1) % renderEvery == 0) || goldenFrame;
+		if (render)
+			renderedFrames++;
+
+		CFrameCheck c = Step(game, render);
+		objectsUpdated += c.updated;
+		maxObjectsUpdated = max(maxObjectsUpdated, c.updated);
+
+		chrono::steady_clock::time_point frameEnd = chrono::steady_clock::now();
+		frameTimes.push_back(chrono::duration<double, micro>(frameEnd - frameStart).count());
+
+#ifdef SMB3_SOFTWARE_RENDERER
+		if (goldenFrame)
+			goldens->Take(frame, softwareRenderer->GetOutput(),
+				softwareRenderer->GetOutputWidth(), softwareRenderer->GetOutputHeight());
+#endif
+
+		if (rollbackScene != NULL)
+			checks.push_back(c);
+
+		if (hashLog != NULL)
+			fprintf(hashLog, "%d %d %016llx\n", frame, c.scene, (unsigned long long)c.hash);
+		if (hashCheckPath != NULL && hashMismatch < 0 && frame < (int)referenceHashes.size())
+		{
+			CFrameCheck& expected = referenceHashes[frame];
+			if (c.scene != expected.scene || c.hash != expected.hash)
+			{
+				hashMismatch = frame;
+				hashFound = c;
+				hashExpected = expected;
+			}
+		}
+	}
+	double runTime = chrono::duration<double, milli>(chrono::steady_clock::now() - runStart).count();
+	int endScene = game->GetCurrentSceneId();
+	ULONGLONG spritesAfter = *spritesDrawn;
+
+	vector<double> sorted(frameTimes);
+	sort(sorted.begin(), sorted.end());
+	double totalFrameTime = 0;
+	for (size_t i = 0; i < frameTimes.size(); i++)
+		totalFrameTime += frameTimes[i];
+	int n = max(frames, 1);
+
+	printf("scene %d -> %d, %d frames (%.1f s of game time) in %.1f ms, %.0f frames/s, x%.0f game speed\n",
+		startScene, endScene, frames, frames * SIMULATION_STEP / 1000.0,
+		runTime, runTime > 0 ? frames * 1000.0 / runTime : 0,
+		runTime > 0 ? frames * SIMULATION_STEP / runTime : 0);
+	printf("frame time (us): mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+		totalFrameTime / n, Percentile(sorted, 0.50), Percentile(sorted, 0.90),
+		Percentile(sorted, 0.99), sorted.empty() ? 0 : sorted.back());
+	printf("objects updated: %llu total, %.1f per frame, %d max\n",
+		(unsigned long long)objectsUpdated, (double)objectsUpdated / n, maxObjectsUpdated);
+	if (renderedFrames > 0)
+	{
+		CRenderStats stats = batchRenderer->GetTotalStats();
+		int renderFrames = max(batchRenderer->GetFrames(), 1);
+		printf("sprites drawn: %.1f per rendered frame, %d frames rendered\n",
+			(double)(spritesAfter - spritesBefore) / renderedFrames, renderedFrames);
+		printf("render time (us): mean %.1f per rendered frame, %.0f frames/s\n",
+			renderTime / renderedFrames, renderTime > 0 ? renderedFrames * 1e6 / renderTime : 0);
+#ifdef SMB3_SOFTWARE_RENDERER
+		if (softwareRenderer != NULL)
+		{
+			// two builds drawing the same frames have the same hash, whatever their kernels
+			CStateHash h;
+			h.AddBytes(softwareRenderer->GetOutput(),
+				softwareRenderer->GetOutputWidth() * softwareRenderer->GetOutputHeight() * sizeof(uint32_t));
+			printf("software frame: %dx%d, %s kernels, last frame hash %016llx\n",
+				softwareRenderer->GetOutputWidth(), softwareRenderer->GetOutputHeight(),
+				GetBlitKernels(), (unsigned long long)h.Get());
+		}
+#endif
+		printf("draw batches: %.1f per rendered frame, %.1f texture switches (%.1f in draw order)%s\n",
+			(double)stats.batches / renderFrames, (double)stats.textureSwitches / renderFrames,
+			(double)stats.textureSwitchesSubmitted / renderFrames, batch ? "" : ", batching off");
+		printf("texture atlases: %d in the scene%s\n", CTextures::GetInstance()->GetAtlasCount(), atlas ? "" : ", packing off");
+
+		Map* map = SceneMap(game->GetCurrentScene());
+		if (map != NULL && chunkBudget > 0)
+		{
+			const CMapChunkStats& chunks = map->GetChunkCache()->GetStats();
+			printf("map chunks: %.1f per rendered frame, %llu hits, %llu misses, %llu evicted, %llu drawn by tiles, %d kept in %d KB\n",
+				(double)(chunks.hits + chunks.misses + chunks.overflows) / renderedFrames,
+				(unsigned long long)chunks.hits, (unsigned long long)chunks.misses,
+				(unsigned long long)chunks.evictions, (unsigned long long)chunks.overflows,
+				map->GetChunkCache()->GetCount(), (int)(map->GetChunkCache()->GetBytes() / 1024));
+		}
+	}
+	if (missingTextures > 0)
+		printf("[WARNING] %d textures of the scene were not found\n", missingTextures);
+	if (replay != NULL && !replay->IsFinished())
+		printf("[WARNING] %d steps of the input log were not replayed\n", (int)(replay->GetSteps() - replay->GetStep()));
+	if (recorder != NULL)
+		printf("recorded %d steps to %s\n", (int)recorder->GetRecordedSteps(), recordPath);
+	if (hashLog != NULL)
+	{
+		fclose(hashLog);
+		printf("wrote %d state hashes to %s\n", frames, hashLogPath);
+	}
+
+	int result = 0;
+	if (hashCheckPath != NULL)
+	{
+		int compared = min(frames, (int)referenceHashes.size());
+		if (hashMismatch >= 0)
+		{
+			printf("state hash differs from %s at frame %d: scene %d hash %016llx, expected scene %d hash %016llx\n",
+				hashCheckPath, hashMismatch, hashFound.scene, (unsigned long long)hashFound.hash,
+				hashExpected.scene, (unsigned long long)hashExpected.hash);
+			result = 1;
+		}
+		else
+			printf("state hash matches %s for %d frames\n", hashCheckPath, compared);
+		if (compared < frames)
+			printf("[WARNING] %s has no hashes past frame %d\n", hashCheckPath, compared);
+	}
+#ifdef SMB3_SOFTWARE_RENDERER
+	if (goldens != NULL)
+	{
+		if (!goldens->Report())
+			result = 1;
+		delete goldens;
+	}
+#endif
+
+	if (rollbackFrame >= 0)
+	{
+		chrono::steady_clock::time_point restoreStart = chrono::steady_clock::now();
+		if (rollbackScene == NULL || game->GetCurrentScene() != rollbackScene || !rollbackScene->RestoreSnapshot(snapshot))
+		{
+			printf("rollback: no play scene to go back to at frame %d\n", rollbackFrame);
+			snapshot.Clear();
+			delete world;
+			return 1;
+		}
+		double restoreTime = chrono::duration<double, micro>(chrono::steady_clock::now() - restoreStart).count();
+
+		*keyboard = rollbackKeys;
+		nextKey = rollbackNextKey;
+		int mismatch = -1;
+		for (int frame = rollbackFrame; frame < frames; frame++)
+		{
+			for (; nextKey < script.size() && script[nextKey].frame <= frame; nextKey++)
+				keyboard->SetKey(script[nextKey].keyCode, script[nextKey].down);
+
+			CFrameCheck c = Step(game, renderEvery > 0 && (frame + 1) % renderEvery == 0);
+			if (mismatch < 0 && !SameFrame(c, checks[frame - rollbackFrame]))
+				mismatch = frame;
+		}
+
+		printf("rollback to frame %d: snapshot %.1f KB, save %.1f us, restore %.1f us, ",
+			rollbackFrame, snapshot.GetSize() / 1024.0, saveTime, restoreTime);
+		if (mismatch < 0)
+			printf("rerun of %d frames matches\n", frames - rollbackFrame);
+		else
+			printf("rerun differs from frame %d\n", mismatch);
+	}
+
+	snapshot.Clear();		// before the world whose objects it holds
+	delete world;
+	return result;
+}
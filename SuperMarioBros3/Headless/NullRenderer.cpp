@@ -0,0 +1,61 @@
+#include <fstream>
+#include <string.h>
+
+#include "NullRenderer.h"
+#include "../Utils.h"
+
+bool CNullRenderer::Init(HWND hWnd, int width, int height)
+{
+	return true;
+}
+
+/*
+	The image is never decoded, the file is only checked to be there so a wrong path in the
+	scene files still shows up as a missing texture. The size comes from the IHDR chunk,
+	which a PNG starts with
+*/
+LPTEXTURE CNullRenderer::LoadTexture(LPCWSTR filePath, COLOR transparentColor)
+{
+	ifstream f;
+	OpenDataFile(f, filePath, ios_base::in | ios_base::binary);
+	if (!f)
+	{
+		texturesMissing++;
+		return NULL;
+	}
+
+	CTexture* texture = new CTexture();
+	BYTE header[24];
+	if (f.read((char*)header, sizeof(header)) && memcmp(header + 1, "PNG", 3) == 0)
+	{
+		texture->width = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+		texture->height = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+	}
+
+	texturesLoaded++;
+	return texture;
+}
+
+LPTEXTURE CNullRenderer::CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies)
+{
+	CTexture* atlas = new CTexture();
+	atlas->width = width;
+	atlas->height = height;
+	texturesMade++;
+	return atlas;
+}
+
+void CNullRenderer::BeginFrame(COLOR background)
+{
+}
+
+void CNullRenderer::Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha)
+{
+	if (texture != NULL)
+		spritesDrawn++;
+}
+
+void CNullRenderer::EndFrame()
+{
+	framesPresented++;
+}
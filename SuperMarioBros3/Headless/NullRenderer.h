@@ -0,0 +1,26 @@
+#pragma once
+#include "../Renderer.h"
+
+/*
+	Renderer for builds without a GPU: textures hold no pixels (only the size, read from
+	the PNG header) and nothing is drawn, the calls are only counted
+*/
+class CNullRenderer : public CRenderer
+{
+public:
+	ULONGLONG spritesDrawn = 0;
+	ULONGLONG framesPresented = 0;
+	int texturesLoaded = 0;
+	int texturesMissing = 0;
+	int texturesMade = 0;		// by CreateAtlas, atlases and map chunks
+
+	bool Init(HWND hWnd, int width, int height);
+
+	LPTEXTURE LoadTexture(LPCWSTR filePath, COLOR transparentColor);
+	LPTEXTURE CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies);
+	bool UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies) { return true; }
+
+	void BeginFrame(COLOR background);
+	void Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha);
+	void EndFrame();
+};
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <thread>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Windows.h>
+
+using namespace std;
+
+static int clientWidth = 0;
+static int clientHeight = 0;
+static bool debugOutput = false;
+
+void HeadlessSetClientSize(int width, int height)
+{
+	clientWidth = width;
+	clientHeight = height;
+}
+
+void HeadlessSetDebugOutput(bool enabled)
+{
+	debugOutput = enabled;
+}
+
+ULONGLONG GetTickCount64()
+{
+	return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count)
+{
+	count->QuadPart = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000LL;
+	return TRUE;
+}
+
+void Sleep(DWORD ms)
+{
+	this_thread::sleep_for(chrono::milliseconds(ms));
+}
+
+void OutputDebugString(LPCWSTR text)
+{
+	if (debugOutput)
+		fputws(text, stderr);
+}
+
+BOOL GetClientRect(HWND hWnd, RECT* rect)
+{
+	rect->left = 0;
+	rect->top = 0;
+	rect->right = clientWidth - 1;
+	rect->bottom = clientHeight - 1;
+	return TRUE;
+}
+
+LONG GetWindowLong(HWND hWnd, int index)
+{
+	return 0;
+}
+
+/*
+	MSVC reads %s in a wide format as a wide string, glibc as a narrow one: turn it into %ls
+*/
+int vswprintf_s(wchar_t* buffer, size_t count, const wchar_t* format, va_list args)
+{
+	wstring converted;
+	for (const wchar_t* c = format; *c != 0; c++)
+	{
+		converted += *c;
+		if (*c != L'%')
+			continue;
+		c++;
+		if (*c == 0)
+			break;
+		if (*c == L'%')
+		{
+			converted += *c;
+			continue;
+		}
+		// flags, width and precision come before the conversion letter
+		while (*c != 0 && wcschr(L"-+ #0123456789.*", *c) != NULL)
+			converted += *c++;
+		if (*c == 0)
+			break;
+		if (*c == L's')
+			converted += L'l';
+		converted += *c;
+	}
+
+	int n = vswprintf(buffer, count, converted.c_str(), args);
+	if (n < 0 && count > 0)
+		buffer[count - 1] = 0;		// truncated, keep what fit
+	return n;
+}
+
+int mbstowcs_s(size_t* converted, wchar_t* dest, size_t destSize, const char* src, size_t count)
+{
+	size_t n = mbstowcs(dest, src, destSize - 1);
+	if (n == (size_t)-1)
+		n = 0;
+	dest[n] = 0;
+	if (converted != NULL)
+		*converted = n + 1;
+	return 0;
+}
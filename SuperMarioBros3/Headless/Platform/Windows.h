@@ -0,0 +1,90 @@
+#pragma once
+
+/*
+	The part of the Win32 API the game code uses, for the headless build on other systems.
+	Functions are implemented by Windows.cpp
+*/
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <wchar.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+// sized as on Windows, where long is 32 bits
+typedef uint32_t DWORD;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t UINT;
+typedef int32_t LONG;
+typedef int BOOL;
+typedef int32_t HRESULT;
+typedef uint64_t ULONGLONG;
+typedef void VOID;
+typedef char* LPSTR;
+typedef const wchar_t* LPCWSTR;
+typedef void* HWND;
+typedef void* HINSTANCE;
+
+#define TRUE	1
+#define FALSE	0
+
+#define WINAPI
+#define CALLBACK
+
+#define S_OK		((HRESULT)0)
+#define E_FAIL		((HRESULT)0x80004005)
+#define SUCCEEDED(hr)	(((HRESULT)(hr)) >= 0)
+#define FAILED(hr)		(((HRESULT)(hr)) < 0)
+
+#define GWL_HINSTANCE	(-6)
+
+#define _TRUNCATE	((size_t)-1)
+
+struct RECT
+{
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+};
+
+union LARGE_INTEGER
+{
+	struct
+	{
+		DWORD LowPart;
+		LONG HighPart;
+	};
+	long long QuadPart;
+};
+
+#define ZeroMemory(dest, size) memset((dest), 0, (size))
+
+ULONGLONG GetTickCount64();
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+void Sleep(DWORD ms);
+
+void OutputDebugString(LPCWSTR text);
+
+BOOL GetClientRect(HWND hWnd, RECT* rect);
+LONG GetWindowLong(HWND hWnd, int index);
+
+// MSVC secure CRT, %s takes a wide string as it does there
+int vswprintf_s(wchar_t* buffer, size_t count, const wchar_t* format, va_list args);
+template <size_t size>
+int vswprintf_s(wchar_t (&buffer)[size], const wchar_t* format, va_list args)
+{
+	return vswprintf_s(buffer, size, format, args);
+}
+int mbstowcs_s(size_t* converted, wchar_t* dest, size_t destSize, const char* src, size_t count);
+
+// headless only: the client area GetClientRect reports and whether OutputDebugString prints
+void HeadlessSetClientSize(int width, int height);
+void HeadlessSetDebugOutput(bool enabled);
@@ -0,0 +1,46 @@
+#include <string.h>
+
+#include "ScriptedKeyboard.h"
+
+CScriptedKeyboard::CScriptedKeyboard()
+{
+	memset(keyStates, 0, sizeof(keyStates));
+}
+
+bool CScriptedKeyboard::Init(HWND hWnd)
+{
+	return true;
+}
+
+bool CScriptedKeyboard::GetKeyStates(BYTE states[256])
+{
+	memcpy(states, keyStates, sizeof(keyStates));
+	return true;
+}
+
+int CScriptedKeyboard::GetKeyEvents(CKeyEvent* events, int maxEvents)
+{
+	int n = min((int)keyEvents.size(), maxEvents);
+	for (int i = 0; i < n; i++)
+		events[i] = keyEvents[i];
+	keyEvents.erase(keyEvents.begin(), keyEvents.begin() + n);
+	return n;
+}
+
+/*
+	Press or release a key, queued as an event too when its state changes
+*/
+void CScriptedKeyboard::SetKey(int keyCode, bool down)
+{
+	BYTE state = down ? 0x80 : 0;
+	if (keyStates[keyCode] == state)
+		return;
+	keyStates[keyCode] = state;
+
+	if (keyEvents.size() >= SCRIPTED_KEYBOARD_BUFFER_SIZE)
+		return;		// a real device drops them too when its buffer is full
+	CKeyEvent e;
+	e.keyCode = keyCode;
+	e.down = down;
+	keyEvents.push_back(e);
+}
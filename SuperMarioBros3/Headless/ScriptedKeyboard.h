@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "../Input.h"
+
+using namespace std;
+
+#define SCRIPTED_KEYBOARD_BUFFER_SIZE	1024
+
+/*
+	Keyboard without a device: reports the keys set with SetKey, as a script plays them
+*/
+class CScriptedKeyboard : public CInput
+{
+	BYTE keyStates[256];
+	vector<CKeyEvent> keyEvents;	// key changes not read by GetKeyEvents yet
+
+public:
+	CScriptedKeyboard();
+
+	bool Init(HWND hWnd);
+
+	bool GetKeyStates(BYTE states[256]);
+	int GetKeyEvents(CKeyEvent* events, int maxEvents);
+
+	void SetKey(int keyCode, bool down);
+};
@@ -0,0 +1,173 @@
+#include <fstream>
+#include <iterator>
+#include <string.h>
+#include <math.h>
+#include <png.h>
+
+#include "SoftwareRenderer.h"
+#include "Blit.h"
+#include "../Utils.h"
+
+bool CSoftwareRenderer::Init(HWND hWnd, int width, int height)
+{
+	this->width = width;
+	this->height = height;
+	frame.assign(width * height, 0);
+	SetScale(scale);
+	return true;
+}
+
+void CSoftwareRenderer::SetScale(int scale)
+{
+	this->scale = max(scale, 1);
+	if (this->scale > 1)
+		output.assign(width * this->scale * height * this->scale, 0);
+	else
+		output.clear();
+}
+
+LPTEXTURE CSoftwareRenderer::LoadTexture(LPCWSTR filePath, COLOR transparentColor)
+{
+	ifstream f;
+	OpenDataFile(f, filePath, ios_base::in | ios_base::binary);
+	if (!f)
+	{
+		texturesMissing++;
+		return NULL;
+	}
+	vector<char> data((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+
+	png_image image;
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_memory(&image, data.data(), data.size()))
+	{
+		DebugOut(L"[ERROR] Cannot decode %s\n", filePath);
+		texturesMissing++;
+		return NULL;
+	}
+
+	CSoftwareTexture* texture = new CSoftwareTexture();
+	texture->width = image.width;
+	texture->height = image.height;
+	texture->pixels.resize(image.width * image.height);
+	image.format = PNG_FORMAT_RGBA;
+	if (!png_image_finish_read(&image, NULL, texture->pixels.data(), 0, NULL))
+	{
+		DebugOut(L"[ERROR] Cannot decode %s\n", filePath);
+		delete texture;
+		texturesMissing++;
+		return NULL;
+	}
+
+	// the key is compared as ARGB, alpha included
+	for (size_t i = 0; i < texture->pixels.size(); i++)
+	{
+		uint32_t p = texture->pixels[i];
+		COLOR argb = (p & 0xff000000) | (p & 0xff) << 16 | (p & 0xff00) | (p >> 16 & 0xff);
+		if (argb == transparentColor)
+			texture->pixels[i] = p = 0;
+
+		uint32_t a = p >> 24;
+		if (a == 0 && texture->alphaKind == SOFTWARE_ALPHA_OPAQUE)
+			texture->alphaKind = SOFTWARE_ALPHA_KEYED;
+		else if (a != 0 && a != 255)
+			texture->alphaKind = SOFTWARE_ALPHA_BLENDED;
+	}
+
+	texturesLoaded++;
+	return texture;
+}
+
+void CSoftwareRenderer::Copy(CSoftwareTexture* atlas, const vector<CAtlasCopy>& copies)
+{
+	for (size_t i = 0; i < copies.size(); i++)
+	{
+		const CAtlasCopy& c = copies[i];
+		CSoftwareTexture* source = (CSoftwareTexture*)c.source;
+		for (int row = 0; row < c.bottom - c.top; row++)
+			memcpy(&atlas->pixels[(c.y + row) * atlas->width + c.x],
+				&source->pixels[(c.top + row) * source->width + c.left], (c.right - c.left) * 4);
+		atlas->alphaKind = max(atlas->alphaKind, source->alphaKind);
+	}
+}
+
+/*
+	An atlas has transparent space around its parts, it is keyed at least
+*/
+LPTEXTURE CSoftwareRenderer::CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies)
+{
+	CSoftwareTexture* atlas = new CSoftwareTexture();
+	atlas->width = width;
+	atlas->height = height;
+	atlas->pixels.assign(width * height, 0);
+	atlas->alphaKind = SOFTWARE_ALPHA_KEYED;
+	Copy(atlas, copies);
+	return atlas;
+}
+
+bool CSoftwareRenderer::UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies)
+{
+	CSoftwareTexture* t = (CSoftwareTexture*)atlas;
+	for (int y = top; y < bottom; y++)
+		memset(&t->pixels[y * t->width + left], 0, (right - left) * 4);
+	Copy(t, copies);
+	return true;
+}
+
+void CSoftwareRenderer::BeginFrame(COLOR background)
+{
+	uint32_t p = 0xff000000 | (background & 0xff) << 16 | (background & 0xff00) | (background >> 16 & 0xff);
+	fill(frame.begin(), frame.end(), p);
+}
+
+void CSoftwareRenderer::Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha)
+{
+	if (texture == NULL)
+		return;
+	spritesDrawn++;
+
+	CSoftwareTexture* t = (CSoftwareTexture*)texture;
+	left = max(left, 0);
+	top = max(top, 0);
+	right = min(right, t->width);
+	bottom = min(bottom, t->height);
+
+	// clipped to the frame
+	int dx = (int)lroundf(x), dy = (int)lroundf(y);
+	if (dx < 0) { left -= dx; dx = 0; }
+	if (dy < 0) { top -= dy; dy = 0; }
+	int w = min(right - left, width - dx);
+	int h = min(bottom - top, height - dy);
+	if (w <= 0 || h <= 0 || alpha <= 0)
+		return;
+	alpha = min(alpha, 255);
+
+	for (int row = 0; row < h; row++)
+	{
+		uint32_t* dst = &frame[(dy + row) * width + dx];
+		const uint32_t* src = &t->pixels[(top + row) * t->width + left];
+		if (alpha < 255 || t->alphaKind == SOFTWARE_ALPHA_BLENDED)
+			BlitBlend(dst, src, w, alpha);
+		else if (t->alphaKind == SOFTWARE_ALPHA_KEYED)
+			BlitKeyed(dst, src, w);
+		else
+			memcpy(dst, src, w * 4);
+	}
+}
+
+void CSoftwareRenderer::EndFrame()
+{
+	framesPresented++;
+	if (scale == 1)
+		return;
+
+	int outWidth = width * scale;
+	for (int y = 0; y < height; y++)
+	{
+		uint32_t* first = &output[y * scale * outWidth];
+		ScaleRow(first, &frame[y * width], width, scale);
+		for (int k = 1; k < scale; k++)
+			memcpy(first + k * outWidth, first, outWidth * 4);
+	}
+}
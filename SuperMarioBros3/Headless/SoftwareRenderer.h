@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "../Renderer.h"
+
+using namespace std;
+
+// what the alpha of a texture's pixels takes, the kernel Draw picks depends on it
+#define SOFTWARE_ALPHA_OPAQUE	0		// all 255, rows are copied
+#define SOFTWARE_ALPHA_KEYED	1		// 0 or 255, transparent pixels are skipped
+#define SOFTWARE_ALPHA_BLENDED	2		// anything, every pixel is blended
+
+class CSoftwareTexture : public CTexture
+{
+public:
+	vector<uint32_t> pixels;		// width x height, bytes R, G, B, A
+	int alphaKind = SOFTWARE_ALPHA_OPAQUE;
+};
+
+/*
+	Draws on the CPU into a frame of 32 bit pixels (bytes R, G, B, A), with the row kernels of
+	Blit.h. Textures are decoded with libpng, the pixels of the color key made transparent as
+	D3DX does, and a draw blends the way the D3DX sprite does with D3DXSPRITE_ALPHABLEND:
+	by the pixel's alpha times the alpha of the draw.
+
+	At EndFrame the frame is scaled up by a whole number for the output, GetOutput.
+*/
+class CSoftwareRenderer : public CRenderer
+{
+	int width = 0;
+	int height = 0;
+	int scale = 1;
+	vector<uint32_t> frame;
+	vector<uint32_t> output;		// the frame scaled up, when scale > 1
+
+	void Copy(CSoftwareTexture* atlas, const vector<CAtlasCopy>& copies);
+
+public:
+	ULONGLONG spritesDrawn = 0;
+	ULONGLONG framesPresented = 0;
+	int texturesLoaded = 0;
+	int texturesMissing = 0;
+
+	bool Init(HWND hWnd, int width, int height);
+	void SetScale(int scale);
+
+	LPTEXTURE LoadTexture(LPCWSTR filePath, COLOR transparentColor);
+	LPTEXTURE CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies);
+	bool UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies);
+
+	void BeginFrame(COLOR background);
+	void Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha);
+	void EndFrame();
+
+	// the last frame, GetOutputWidth x GetOutputHeight pixels
+	const uint32_t* GetOutput() { return scale > 1 ? &output[0] : &frame[0]; }
+	int GetOutputWidth() { return width * scale; }
+	int GetOutputHeight() { return height * scale; }
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <Windows.h>
+
+struct CKeyEvent
+{
+	int keyCode;	// DIK_ scan code
+	bool down;
+};
+
+/*
+	Keyboard as the game reads it once per step: the state of every key, then the presses
+	and releases since the last step. CDirectInputKeyboard reads DirectInput 8,
+	CScriptedKeyboard (Headless) plays keys set by a script
+*/
+class CInput
+{
+public:
+	virtual bool Init(HWND hWnd) = 0;
+
+	// false when the keyboard cannot be read this time
+	virtual bool GetKeyStates(BYTE states[256]) = 0;
+	// returns how many events were written, at most maxEvents
+	virtual int GetKeyEvents(CKeyEvent* events, int maxEvents) = 0;
+
+	virtual ~CInput() {}
+};
+typedef CInput * LPINPUT;
@@ -0,0 +1,253 @@
+#include <string.h>
+
+#include "InputLog.h"
+#include "Utils.h"
+#include "Game.h"
+
+static void WriteU8(ofstream& f, BYTE v)
+{
+	f.put((char)v);
+}
+
+static void WriteU16(ofstream& f, WORD v)
+{
+	WriteU8(f, v & 0xFF);
+	WriteU8(f, v >> 8);
+}
+
+static void WriteU32(ofstream& f, DWORD v)
+{
+	WriteU16(f, v & 0xFFFF);
+	WriteU16(f, v >> 16);
+}
+
+static BYTE ReadU8(ifstream& f)
+{
+	return (BYTE)f.get();
+}
+
+static WORD ReadU16(ifstream& f)
+{
+	WORD lo = ReadU8(f);
+	return lo | (ReadU8(f) << 8);
+}
+
+static DWORD ReadU32(ifstream& f)
+{
+	DWORD lo = ReadU16(f);
+	return lo | ((DWORD)ReadU16(f) << 16);
+}
+
+CInputRecorder::CInputRecorder(LPINPUT source)
+{
+	this->source = source;
+	memset(lastStates, 0, sizeof(lastStates));
+	memset(states, 0, sizeof(states));
+}
+
+bool CInputRecorder::Open(LPCWSTR path, int sceneId)
+{
+	OpenDataFile(log, path, ios_base::out | ios_base::binary | ios_base::trunc);
+	if (!log)
+	{
+		DebugOut(L"[ERROR] Cannot create input log %s\n", path);
+		return false;
+	}
+
+	log.write(INPUT_LOG_MAGIC, INPUT_LOG_MAGIC_SIZE);
+	WriteU16(log, INPUT_LOG_VERSION);
+	WriteU16(log, SIMULATION_STEP);
+	WriteU32(log, (DWORD)sceneId);
+	WriteU32(log, 0);		// steps, filled in when the recording ends
+	return true;
+}
+
+bool CInputRecorder::Init(HWND hWnd)
+{
+	return source->Init(hWnd);
+}
+
+bool CInputRecorder::GetKeyStates(BYTE states[256])
+{
+	if (statesRead)
+		WriteStep(NULL, 0);		// the events of the last step were never asked for
+
+	if (!source->GetKeyStates(states))
+	{
+		if (log.is_open())
+		{
+			WriteU8(log, 0);
+			steps++;
+		}
+		return false;
+	}
+
+	memcpy(this->states, states, sizeof(this->states));
+	statesRead = true;
+	return true;
+}
+
+int CInputRecorder::GetKeyEvents(CKeyEvent* events, int maxEvents)
+{
+	int n = source->GetKeyEvents(events, maxEvents);
+	if (statesRead)
+		WriteStep(events, n);
+	return n;
+}
+
+void CInputRecorder::WriteStep(CKeyEvent* events, int n)
+{
+	statesRead = false;
+	if (!log.is_open())
+		return;
+
+	int changes = 0;
+	for (int i = 0; i < 256; i++)
+		if (states[i] != lastStates[i]) changes++;
+
+	WriteU8(log, 1);
+	WriteU16(log, changes);
+	for (int i = 0; i < 256; i++)
+	{
+		if (states[i] == lastStates[i]) continue;
+		WriteU8(log, i);
+		WriteU8(log, states[i]);
+	}
+	memcpy(lastStates, states, sizeof(lastStates));
+
+	WriteU16(log, n);
+	for (int i = 0; i < n; i++)
+	{
+		WriteU8(log, events[i].keyCode);
+		WriteU8(log, events[i].down ? 1 : 0);
+	}
+	steps++;
+}
+
+CInputRecorder::~CInputRecorder()
+{
+	if (log.is_open())
+	{
+		if (statesRead)
+			WriteStep(NULL, 0);
+		log.seekp(INPUT_LOG_HEADER_SIZE - 4);
+		WriteU32(log, steps);
+		log.close();
+	}
+	delete source;
+}
+
+CInputReplay::CInputReplay()
+{
+	memset(states, 0, sizeof(states));
+}
+
+bool CInputReplay::Open(LPCWSTR path)
+{
+	OpenDataFile(log, path, ios_base::in | ios_base::binary);
+	if (!log)
+	{
+		DebugOut(L"[ERROR] Cannot open input log %s\n", path);
+		return false;
+	}
+
+	char magic[INPUT_LOG_MAGIC_SIZE];
+	log.read(magic, INPUT_LOG_MAGIC_SIZE);
+	int version = ReadU16(log);
+	if (!log || memcmp(magic, INPUT_LOG_MAGIC, INPUT_LOG_MAGIC_SIZE) != 0 || version != INPUT_LOG_VERSION)
+	{
+		DebugOut(L"[ERROR] %s is not an input log of this version\n", path);
+		log.close();
+		return false;
+	}
+
+	stepTime = ReadU16(log);
+	sceneId = (int)ReadU32(log);
+	steps = ReadU32(log);
+
+	// the recorder fills the count in when it ends: a log left by a crash still has 0, its
+	// steps are the full records that made it to the file
+	if (steps == 0)
+	{
+		streampos first = log.tellg();
+		bool read;
+		while (ReadStep(read))
+			steps++;
+		log.clear();
+		log.seekg(first);
+		memset(states, 0, sizeof(states));
+		events.clear();
+		if (steps > 0)
+			DebugOut(L"[WARNING] Input log %s was not closed, replaying its %d full steps\n", path, (int)steps);
+	}
+
+	if (stepTime != SIMULATION_STEP)
+		DebugOut(L"[WARNING] Input log was recorded at %d ms steps, this build runs %d ms steps\n", stepTime, SIMULATION_STEP);
+
+	DebugOut(L"[INFO] Input log %s: %d steps from scene %d\n", path, (int)steps, sceneId);
+	return true;
+}
+
+bool CInputReplay::Init(HWND hWnd)
+{
+	return log.is_open();
+}
+
+/*
+	Read the next record into states and events, false when the log is over or broken
+*/
+bool CInputReplay::ReadStep(bool& read)
+{
+	events.clear();
+	read = ReadU8(log) != 0;
+	if (!read)
+		return (bool)log;
+
+	int changes = ReadU16(log);
+	for (int i = 0; i < changes && log; i++)
+	{
+		int keyCode = ReadU8(log);
+		states[keyCode] = ReadU8(log);
+	}
+
+	int n = ReadU16(log);
+	if (n > INPUT_LOG_MAX_EVENTS)
+		return false;
+	for (int i = 0; i < n && log; i++)
+	{
+		CKeyEvent e;
+		e.keyCode = ReadU8(log);
+		e.down = ReadU8(log) != 0;
+		events.push_back(e);
+	}
+	return (bool)log;
+}
+
+bool CInputReplay::GetKeyStates(BYTE states[256])
+{
+	if (IsFinished())
+		return false;
+
+	bool read;
+	if (!ReadStep(read))
+	{
+		DebugOut(L"[ERROR] Input log is cut at step %d of %d\n", (int)step, (int)steps);
+		step = steps;
+		return false;
+	}
+	step++;
+	if (!read)
+		return false;
+
+	memcpy(states, this->states, sizeof(this->states));
+	return true;
+}
+
+int CInputReplay::GetKeyEvents(CKeyEvent* events, int maxEvents)
+{
+	int n = min((int)this->events.size(), maxEvents);
+	for (int i = 0; i < n; i++)
+		events[i] = this->events[i];
+	this->events.clear();
+	return n;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <fstream>
+#include <vector>
+#include "Input.h"
+
+using namespace std;
+
+/*
+	Input log: the keyboard as ProcessKeyboard read it, one record per simulation step.
+
+	Header (little endian):
+		"SMB3KEYS"		8 bytes
+		version			uint16
+		step			uint16, SIMULATION_STEP of the recording in ms
+		scene			int32, scene the recording started in
+		steps			uint32, number of step records, 0 until the recording ends
+
+	Step record:
+		read			uint8, 0 when the keyboard could not be read that step (nothing follows)
+		changes			uint16, then per key whose state changed since the last read step:
+						uint8 key code, uint8 state
+		events			uint16, then per buffered event: uint8 key code, uint8 down
+*/
+#define INPUT_LOG_MAGIC			"SMB3KEYS"
+#define INPUT_LOG_MAGIC_SIZE	8
+#define INPUT_LOG_VERSION		1
+#define INPUT_LOG_HEADER_SIZE	20
+#define INPUT_LOG_MAX_EVENTS	1024
+
+/*
+	Records the keyboard read through it into an input log, the input it wraps is owned and
+	deleted with the recorder. The step count in the header is written when the recorder is
+	deleted, a log cut short by a crash keeps 0 there and replays up to its last full record
+	(see CInputReplay::Open)
+*/
+class CInputRecorder : public CInput
+{
+	LPINPUT source;
+	ofstream log;
+	BYTE lastStates[256];		// states of the last read step, the next record holds the changes
+	BYTE states[256];
+	bool statesRead = false;	// GetKeyStates of this step succeeded, its record waits for the events
+	DWORD steps = 0;
+
+	void WriteStep(CKeyEvent* events, int n);
+
+public:
+	CInputRecorder(LPINPUT source);
+
+	// false when the log cannot be created
+	bool Open(LPCWSTR path, int sceneId);
+
+	bool Init(HWND hWnd);
+
+	bool GetKeyStates(BYTE states[256]);
+	int GetKeyEvents(CKeyEvent* events, int maxEvents);
+
+	DWORD GetRecordedSteps() { return steps; }
+
+	~CInputRecorder();
+};
+
+/*
+	Plays an input log back: each step gets the key states and events recorded for it. Once
+	the log runs out the keyboard reads as unavailable and IsFinished turns true
+*/
+class CInputReplay : public CInput
+{
+	ifstream log;
+	BYTE states[256];
+	vector<CKeyEvent> events;	// events of the step being replayed
+	DWORD step = 0;
+	DWORD steps = 0;
+	int stepTime = 0;
+	int sceneId = -1;
+
+	bool ReadStep(bool& read);
+
+public:
+	CInputReplay();
+
+	// false when the file is missing or is not an input log
+	bool Open(LPCWSTR path);
+
+	bool Init(HWND hWnd);
+
+	bool GetKeyStates(BYTE states[256]);
+	int GetKeyEvents(CKeyEvent* events, int maxEvents);
+
+	int GetSceneId() { return sceneId; }
+	int GetStepTime() { return stepTime; }
+	DWORD GetStep() { return step; }
+	DWORD GetSteps() { return steps; }
+	bool IsFinished() { return step >= steps; }
+};
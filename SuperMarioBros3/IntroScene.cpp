@@ -4,7 +4,6 @@
 #include "IntroScene.h"
 #include "Textures.h"
 #include "Utils.h"
-#include <dinput.h>
 #include "Brick.h"
 #include "Game.h"
 
@@ -52,7 +51,7 @@ void CIntroScene::_ParseSection_TEXTURES(string line)
 	int G = atoi(tokens[3].c_str());
 	int B = atoi(tokens[4].c_str());
 
-	CTextures::GetInstance()->Add(texID, path.c_str(), D3DCOLOR_XRGB(R, G, B));
+	CTextures::GetInstance()->Add(texID, path.c_str(), COLOR_XRGB(R, G, B));
 }
 void CIntroScene::_ParseSection_SPRITES(string line)
 {
@@ -67,7 +66,7 @@ void CIntroScene::_ParseSection_SPRITES(string line)
 	int b = atoi(tokens[4].c_str());
 	int texID = atoi(tokens[5].c_str());
 
-	LPDIRECT3DTEXTURE9 tex = CTextures::GetInstance()->Get(texID);
+	LPTEXTURE tex = CTextures::GetInstance()->Get(texID);
 	if (tex == NULL)
 	{
 		DebugOut(L"[ERROR] Texture ID %d not found!\n", texID);
@@ -234,7 +233,7 @@ void CIntroScene::Load()
 	DebugOut(L"[INFO] Start loading scene resources from : %s \n", sceneFilePath);
 
 	ifstream f;
-	f.open(sceneFilePath);
+	OpenDataFile(f, sceneFilePath);
 
 	// current resource section flag
 	int section = INTROSCENE_SECTION_UNKNOWN;
@@ -268,7 +267,7 @@ void CIntroScene::Load()
 
 	f.close();
 
-	CTextures::GetInstance()->Add(ID_TEX_BBOX, L"textures\\bbox.png", D3DCOLOR_XRGB(255, 255, 255));
+	CTextures::GetInstance()->Add(ID_TEX_BBOX, L"textures\\bbox.png", COLOR_XRGB(255, 255, 255));
 
 	DebugOut(L"[INFO] Done loading scene resources %s\n", sceneFilePath);
 
@@ -280,7 +279,7 @@ void CIntroScene::Render()
 {
 	for (size_t i = 0; i < objects.size(); i++)
 	{
-		objects[i]->Render();
+		objects[i]->RenderInterpolated();
 	}
 	if (bigBush != nullptr)
 		bigBush->Draw(193, 90);
@@ -298,12 +297,15 @@ void CIntroScene::Update(DWORD dt)
 	vector<LPGAMEOBJECT> coObjects;
 	for (size_t i = 1; i < objects.size(); i++)
 	{
+		objects[i]->RefreshBoundingBox();
 		coObjects.push_back(objects[i]);
 	}
 	for (size_t i = 0; i < objects.size(); i++)
 	{
 		objects[i]->Update(dt, &coObjects);
+		objects[i]->RefreshBoundingBox();
 	}
+	updatedObjects = objects.size();
 
 	//DebugOut(L"isFlying: %d \n", mario->IsFlying);
 }
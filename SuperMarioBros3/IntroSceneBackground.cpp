@@ -23,7 +23,7 @@ void CIntroSceneBackground::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 
 void CIntroSceneBackground::GetBoundingBox(float& left, float& top, float& right, float& bottom)
 {
-
+	left = top = right = bottom = 0;
 }
 
 void CIntroSceneBackground::Render()
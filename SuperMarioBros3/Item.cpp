@@ -3,6 +3,7 @@
 
 CItem::CItem()
 {
+	kind = OBJECT_KIND_ITEM;
 	type = ITEM_TYPE_STAR;
 	changeTypeTime = 0;
 	IsIntact = true;
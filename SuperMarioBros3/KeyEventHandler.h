@@ -7,6 +7,7 @@
 class CKeyEventHandler
 {
 public:
+	virtual ~CKeyEventHandler() {}
 	virtual void KeyState(BYTE *state) = 0;
 	virtual void OnKeyDown(int KeyCode) = 0;
 	virtual void OnKeyUp(int KeyCode) = 0;
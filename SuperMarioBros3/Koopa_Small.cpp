@@ -11,6 +11,8 @@
 
 CKoopa_Small::CKoopa_Small(float _x, float _y, int _type) :CKoopas(_x, _y, _type)
 {
+	kind = OBJECT_KIND_KOOPA;
+	waggleTimer = wakeUpTimer = TIMER_NONE;
 	if (_type == KOOPA_SMALL_TYPE_RED_WALKING || _type == KOOPA_SMALL_TYPE_GREEN_WALKING)
 		SetState(KOOPA_SMALL_STATE_WALKING_LEFT);
 	else if ( _type == KOOPA_SMALL_TYPE_GREEN_FLYING)
@@ -114,37 +116,53 @@ void CKoopa_Small::Update_vy()
 			vy = 2.5f*KOOPA_MAX_FALL_SPEED;
 	}
 }
-void CKoopa_Small::UpdateFlag()
+/*
+	The shell starts waggling KOOPA_SMALL_WAGGLE_TIME before it wakes up, both counted
+	from when it became a shell or last stopped running
+*/
+void CKoopa_Small::StartShellTimers()
 {
-	if (type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
+	if (state == KOOPA_SMALL_STATE_RUNNING_LEFT || state == KOOPA_SMALL_STATE_RUNNING_RIGHT)
 	{
-		if (state == KOOPA_SMALL_STATE_RUNNING_LEFT || state == KOOPA_SMALL_STATE_RUNNING_RIGHT)
-		{
-			isTurtoiseshell_start = (DWORD)GetTickCount64();
-		}
-		else if (GetTickCount64() - isTurtoiseshell_start > KOOPA_SMALL_IS_TURTOISESHELL_TIME - KOOPA_SMALL_WAGGLE_TIME && !IsWaggling)
-		{
-			IsWaggling = true;
-		}
-		else if (GetTickCount64() - isTurtoiseshell_start > KOOPA_SMALL_IS_TURTOISESHELL_TIME && IsWaggling)
+		StopShellTimers();
+		return;
+	}
+	isTurtoiseshell_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+	StartTimer(waggleTimer, KOOPA_SMALL_IS_TURTOISESHELL_TIME - KOOPA_SMALL_WAGGLE_TIME, (LPTIMERCALLBACK)&CKoopa_Small::StartWaggling);
+	StartTimer(wakeUpTimer, KOOPA_SMALL_IS_TURTOISESHELL_TIME, (LPTIMERCALLBACK)&CKoopa_Small::WakeUp);
+}
+void CKoopa_Small::StopShellTimers()
+{
+	StopTimer(waggleTimer);
+	StopTimer(wakeUpTimer);
+}
+void CKoopa_Small::StartWaggling()
+{
+	if (!IsEnable || state == KOOPA_SMALL_STATE_DIE)
+		return;
+	IsWaggling = true;
+}
+void CKoopa_Small::WakeUp()
+{
+	if (!IsEnable || state == KOOPA_SMALL_STATE_DIE || !IsWaggling)
+		return;
+	if (type != KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL && type != KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
+		return;
+	IsBeingKnockedDown = false;
+	IsWaggling = false;
+	y = y + KOOPA_SMALL_TURTOISESHELL_BBOX_HEIGHT - KOOPA_SMALL_BBOX_HEIGHT;
+	SetState(KOOPA_SMALL_STATE_WALKING_LEFT);
+	if (type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL)
+		SetType(KOOPA_SMALL_TYPE_GREEN_WALKING);
+	else
+		SetType(KOOPA_SMALL_TYPE_RED_WALKING);
+	IsBeingHeld = false;
+	if(holder != nullptr)
+		if (holder->IsHolding)
 		{
-			IsBeingKnockedDown = false;
-			IsWaggling = false;
-			y = y + KOOPA_SMALL_TURTOISESHELL_BBOX_HEIGHT - KOOPA_SMALL_BBOX_HEIGHT;
-			SetState(KOOPA_SMALL_STATE_WALKING_LEFT);
-			if (type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL)
-				SetType(KOOPA_SMALL_TYPE_GREEN_WALKING);
-			else
-				SetType(KOOPA_SMALL_TYPE_RED_WALKING);
-			IsBeingHeld = false;
-			if(holder != nullptr)
-				if (holder->IsHolding)
-				{
-					holder->IsHolding = false;
-					holder->BeDamaged();
-				}
+			holder->IsHolding = false;
+			holder->BeDamaged();
 		}
-	}
 }
 
 void CKoopa_Small::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
@@ -184,7 +202,6 @@ void CKoopa_Small::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 	
 	CGameObject::Update(dt, coObjects);
 
-	UpdateFlag();
 	if (IsBeingHeld)
 	{
 		BeHeld();
@@ -197,8 +214,6 @@ void CKoopa_Small::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 		UpdateGreenFlying();
 	else if(type == KOOPA_SMALL_TYPE_RED_FLYING)
 		UpdateRedFlying();
-	vector<LPCOLLISIONEVENT> coEvents;
-	vector<LPCOLLISIONEVENT> coEventsResult;
 
 	coEvents.clear();
 	CalcPotentialCollisions(coObjects, coEvents);
@@ -220,116 +235,9 @@ void CKoopa_Small::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 		x = x0 + dx;
 		y = y0 + dy;
 
+		CCollisionContext c(min_tx, min_ty, nx, ny, x0, y0);
 		for (UINT i = 0; i < coEventsResult.size(); i++)
-		{
-			LPCOLLISIONEVENT e = coEventsResult[i];
-			if (dynamic_cast<CBrick*>(e->obj))
-			{
-				CBrick* brick = dynamic_cast<CBrick*>(e->obj);
-				if (brick->GetType() == BRICK_TYPE_BIG_BLOCK)
-				{
-					if (e->ny == -1)
-					{
-						this->vy = 0;
-						this->y = y0 + min_ty * this->dy + e->ny * 0.1f;
-						if (state == KOOPA_SMALL_STATE_BE_KNOCKED_DOWN)
-							SetState(KOOPA_SMALL_STATE_IDLE);
-					}
-					else
-					{
-						x = x0 + dx;
-						y = y0 + dy;
-					}
-				}
-				else
-				{
-					if (e->nx != 0)
-					{
-						this->x = x0 + min_tx * this->dx + e->nx * 0.1f;
-						TurnAround();
-					}
-					if (e->ny != 0)
-					{
-						this->vy = 0;
-						this->y = y0 + min_ty * this->dy + e->ny * 0.1f;
-						if (state == KOOPA_SMALL_STATE_BE_KNOCKED_DOWN)
-							SetState(KOOPA_SMALL_STATE_IDLE);
-					}
-				}
-
-				if (e->ny == -1 && isTouchingGround == false)
-				{
-					isTouchingGround = true;
-					if (state == KOOPA_SMALL_STATE_IDLE)
-						vx = 0;
-				}
-			}
-			else if (dynamic_cast<CRewardBox*>(e->obj))
-			{
-				CRewardBox* rBox = dynamic_cast<CRewardBox*>(e->obj);
-				if (e->nx != 0)
-				{
-					this->x = x0 + min_tx * this->dx + e->nx * 0.1f;
-
-					TurnAround();
-					if (type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
-					{
-						rBox->BeAttacked();
-					}
-				}
-				if (e->ny != 0)
-				{
-					this->vy = 0;
-					this->y = y0 + min_ty * this->dy + e->ny * 0.1f;
-					if (state == KOOPA_SMALL_STATE_BE_KNOCKED_DOWN)
-						SetState(KOOPA_SMALL_STATE_IDLE);
-					if (e->ny == -1 && isTouchingGround == false)
-						isTouchingGround = true;
-				}
-			}
-			else if (dynamic_cast<CGoomba*>(e->obj))
-			{
-
-				CGoomba* goomba = dynamic_cast<CGoomba*>(e->obj);
-				if (type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL || type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL)
-				{
-					if (e->nx != 0)
-					{
-						if (this->state != KOOPA_SMALL_STATE_IDLE)
-						{
-							CGoomba* goomba = dynamic_cast<CGoomba*>(e->obj);
-							goomba->BeDamaged_X(this);
-						}
-					}
-				}
-			}
-			else if (dynamic_cast<CKoopa_Small*>(e->obj))
-			{
-				CKoopa_Small* koopa = dynamic_cast<CKoopa_Small*>(e->obj);
-				if (koopa->type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || koopa->type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
-				{
-					
-					if (koopa->IsBeingHeld)
-					{
-						koopa->SetState(KOOPA_SMALL_STATE_DIE);
-						this->SetState(KOOPA_SMALL_STATE_DIE);
-						koopa->IsBeingHeld = false;
-						if (koopa->holder)
-							koopa->holder->IsHolding = false;
-					}
-					else
-					{
-						if (koopa->state == KOOPA_SMALL_STATE_IDLE)
-							this->TurnAround();
-						else
-						{
-							this->SetState(KOOPA_SMALL_STATE_DIE);
-							this->vx = koopa->nx * KOOPA_BE_KNOCKED_DOWN_SPEED_X;
-						}
-					}
-				}
-			}
-		}
+			RespondToCollision(coEventsResult[i], c);
 
 	}
 
@@ -338,8 +246,6 @@ void CKoopa_Small::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 	CalculateBeSwingedTail();
 	CalculateBeAtackedByBox(coObjects);
 
-	// clean up collision events
-	for (UINT i = 0; i < coEvents.size(); i++) delete coEvents[i];
 	if (type == KOOPA_SMALL_TYPE_RED_FLYING || type == KOOPA_SMALL_TYPE_GREEN_FLYING)
 		Update_Wings();
 
@@ -453,7 +359,14 @@ void CKoopa_Small::Render()
 
 void CKoopa_Small::SetState(int state)
 {
+	bool wasRunning = this->state == KOOPA_SMALL_STATE_RUNNING_LEFT || this->state == KOOPA_SMALL_STATE_RUNNING_RIGHT;
+	bool isShell = type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL;
 	CGameObject::SetState(state);
+	// a running shell never wakes up, its countdown restarts once it stops
+	if (state == KOOPA_SMALL_STATE_RUNNING_LEFT || state == KOOPA_SMALL_STATE_RUNNING_RIGHT)
+		StopShellTimers();
+	else if (wasRunning && isShell)
+		StartShellTimers();
 	switch (state)
 	{
 	case KOOPA_SMALL_STATE_WALKING_RIGHT:
@@ -523,7 +436,9 @@ void CKoopa_Small::SetType(int _type)
 {
 	CEnemy::SetType(_type);
 	if (_type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL || _type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL)
-		isTurtoiseshell_start =(DWORD) GetTickCount64();
+		StartShellTimers();
+	else
+		StopShellTimers();
 }
 
 void CKoopa_Small::BeHeld()
@@ -667,17 +582,23 @@ void CKoopa_Small::CalculateBeSwingedTail()
 }
 void CKoopa_Small::CalculateBeAtackedByBox(vector<LPGAMEOBJECT>* coObjects)
 {
+	float l, t, r, b;
+	RefreshBoundingBox();
+	GetCachedBoundingBox(l, t, r, b);
+	GetNearbyObjects(coObjects, l, t, r, b, nearby);
+	coObjects = &nearby;
+
 	for (unsigned int i = 0; i < coObjects->size(); i++)
 	{
-		if (dynamic_cast<CRewardBox*>(coObjects->at(i)))
+		if (coObjects->at(i)->kind == OBJECT_KIND_REWARD_BOX)
 		{
-			CRewardBox* box = dynamic_cast<CRewardBox*>(coObjects->at(i));
+			CRewardBox* box = (CRewardBox*)coObjects->at(i);
 			if (box->GetState() == REWARD_BOX_STATE_JUMPING)
 			{
 				float bl, bt, br, bb;
-				box->GetBoundingBox(bl, bt, br, bb);
+				box->GetCachedBoundingBox(bl, bt, br, bb);
 				float kl, kt, kr, kb;
-				this->GetBoundingBox(kl, kt, kr, kb);
+				GetCachedBoundingBox(kl, kt, kr, kb);
 				if (kb<bt || kt>bb || bl > kr || br < kl)
 					return;
 				if ((kl<bl && kr>bl) || (kl < br && br < kr))
@@ -716,19 +637,23 @@ bool CKoopa_Small::CalculateTurningAround(vector<LPGAMEOBJECT>* coObjects)
 	if (!isTouchingGround)
 		return false;
 	float kl, kt, kr, kb;
-	GetBoundingBox(kl, kt, kr, kb);
+	RefreshBoundingBox();
+	GetCachedBoundingBox(kl, kt, kr, kb);
+	// the ground we are looking for is at most 2px under our feet
+	GetNearbyObjects(coObjects, kl, kt, kr, kb + 2, nearby);
+	coObjects = &nearby;
 	for (UINT i = 0; i < coObjects->size(); i++)
 	{
 		LPGAMEOBJECT object = coObjects->at(i);
-		if (!object->IsInCamera())
+		if (!object->IsBoxInCamera())
 			continue;
 
-		if (!dynamic_cast<CBrick*>(object) && !dynamic_cast<CRewardBox*>(object))
+		if (object->kind != OBJECT_KIND_BRICK && object->kind != OBJECT_KIND_REWARD_BOX)
 			continue;
 
 		//object is Break or RBox
 		float ol, ot, or , ob;
-		object->GetBoundingBox(ol, ot, or , ob);
+		object->GetCachedBoundingBox(ol, ot, or , ob);
 		/*if (object->x == 2096 && object->y == 384)
 			DebugOut(L"kb: %f, ot: %f \n", kb, ot);*/
 		if (kb > ot - 2 && kb < ot)
@@ -809,4 +734,120 @@ bool CKoopa_Small::IsOnTheLeftOfMario()
 		return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+void CKoopa_Small::RegisterCollisionResponses()
+{
+	SetCollisionResponse(OBJECT_KIND_KOOPA, OBJECT_KIND_BRICK, (LPCOLLISIONRESPONSE)&CKoopa_Small::OnCollisionWithBrick);
+	SetCollisionResponse(OBJECT_KIND_KOOPA, OBJECT_KIND_REWARD_BOX, (LPCOLLISIONRESPONSE)&CKoopa_Small::OnCollisionWithRewardBox);
+	SetCollisionResponse(OBJECT_KIND_KOOPA, OBJECT_KIND_GOOMBA, (LPCOLLISIONRESPONSE)&CKoopa_Small::OnCollisionWithGoomba);
+	SetCollisionResponse(OBJECT_KIND_KOOPA, OBJECT_KIND_KOOPA, (LPCOLLISIONRESPONSE)&CKoopa_Small::OnCollisionWithKoopa);
+}
+
+void CKoopa_Small::OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CBrick* brick = (CBrick*)e->obj;
+	if (brick->GetType() == BRICK_TYPE_BIG_BLOCK)
+	{
+		if (e->ny == -1)
+		{
+			this->vy = 0;
+			this->y = c.y0 + c.min_ty * this->dy + e->ny * 0.1f;
+			if (state == KOOPA_SMALL_STATE_BE_KNOCKED_DOWN)
+				SetState(KOOPA_SMALL_STATE_IDLE);
+		}
+		else
+		{
+			x = c.x0 + dx;
+			y = c.y0 + dy;
+		}
+	}
+	else
+	{
+		if (e->nx != 0)
+		{
+			this->x = c.x0 + c.min_tx * this->dx + e->nx * 0.1f;
+			TurnAround();
+		}
+		if (e->ny != 0)
+		{
+			this->vy = 0;
+			this->y = c.y0 + c.min_ty * this->dy + e->ny * 0.1f;
+			if (state == KOOPA_SMALL_STATE_BE_KNOCKED_DOWN)
+				SetState(KOOPA_SMALL_STATE_IDLE);
+		}
+	}
+
+	if (e->ny == -1 && isTouchingGround == false)
+	{
+		isTouchingGround = true;
+		if (state == KOOPA_SMALL_STATE_IDLE)
+			vx = 0;
+	}
+}
+
+void CKoopa_Small::OnCollisionWithRewardBox(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CRewardBox* rBox = (CRewardBox*)e->obj;
+	if (e->nx != 0)
+	{
+		this->x = c.x0 + c.min_tx * this->dx + e->nx * 0.1f;
+
+		TurnAround();
+		if (type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
+		{
+			rBox->BeAttacked();
+		}
+	}
+	if (e->ny != 0)
+	{
+		this->vy = 0;
+		this->y = c.y0 + c.min_ty * this->dy + e->ny * 0.1f;
+		if (state == KOOPA_SMALL_STATE_BE_KNOCKED_DOWN)
+			SetState(KOOPA_SMALL_STATE_IDLE);
+		if (e->ny == -1 && isTouchingGround == false)
+			isTouchingGround = true;
+	}
+}
+
+void CKoopa_Small::OnCollisionWithGoomba(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CGoomba* goomba = (CGoomba*)e->obj;
+	if (type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL || type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL)
+	{
+		if (e->nx != 0)
+		{
+			if (this->state != KOOPA_SMALL_STATE_IDLE)
+			{
+				goomba->BeDamaged_X(this);
+			}
+		}
+	}
+}
+
+void CKoopa_Small::OnCollisionWithKoopa(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CKoopa_Small* koopa = (CKoopa_Small*)e->obj;
+	if (koopa->type == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || koopa->type == KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
+	{
+		
+		if (koopa->IsBeingHeld)
+		{
+			koopa->SetState(KOOPA_SMALL_STATE_DIE);
+			this->SetState(KOOPA_SMALL_STATE_DIE);
+			koopa->IsBeingHeld = false;
+			if (koopa->holder)
+				koopa->holder->IsHolding = false;
+		}
+		else
+		{
+			if (koopa->state == KOOPA_SMALL_STATE_IDLE)
+				this->TurnAround();
+			else
+			{
+				this->SetState(KOOPA_SMALL_STATE_DIE);
+				this->vx = koopa->nx * KOOPA_BE_KNOCKED_DOWN_SPEED_X;
+			}
+		}
+	}
+}
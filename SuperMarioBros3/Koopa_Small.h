@@ -73,6 +73,14 @@ private:
 	DWORD isTurtoiseshell_start;
 	//DWORD waggle_start;
 
+	// shell timers on the scene's timer wheel, held back while the shell is running
+	int waggleTimer;
+	int wakeUpTimer;
+	void StartShellTimers();
+	void StopShellTimers();
+	void StartWaggling();
+	void WakeUp();
+
 public:
 
 	bool IsBeingKnockedDown;
@@ -89,7 +97,6 @@ public:
 
 
 	void Update_vy();
-	void UpdateFlag();
 	bool CalculateTurningAround(vector<LPGAMEOBJECT>* coObjects);
 	void CalculateBeAtackedByBox(vector<LPGAMEOBJECT>* coObjects);
 	void TurnAround();
@@ -111,5 +118,11 @@ public:
 	virtual void Reset();
 
 	bool IsOnTheLeftOfMario();
+
+	static void RegisterCollisionResponses();
+	void OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithRewardBox(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithGoomba(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithKoopa(LPCOLLISIONEVENT e, CCollisionContext& c);
 };
 
@@ -55,8 +55,6 @@ void CLifeUp::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 	if (vy > LIFEUP_MAX_FALLING_SPEED)
 		vy = LIFEUP_MAX_FALLING_SPEED;
 
-	vector<LPCOLLISIONEVENT> coEvents;
-	vector<LPCOLLISIONEVENT> coEventsResult;
 
 	coEvents.clear();
 	this->CalcPotentialCollisions(coObjects, coEvents);
@@ -93,7 +91,6 @@ void CLifeUp::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 
 	}
 
-	for (UINT i = 0; i < coEvents.size(); i++) delete coEvents[i];
 }
 
 void CLifeUp::SetState(int _state)
@@ -128,40 +125,46 @@ bool CLifeUp::IsOnTheLeftOfMario()
 	}
 	return true;
 }
-void CLifeUp::CalcPotentialCollisions(vector<LPGAMEOBJECT>* coObjects, vector<LPCOLLISIONEVENT>& coEvents)
+void CLifeUp::CalcPotentialCollisions(vector<LPGAMEOBJECT>* coObjects, vector<CCollisionEvent>& coEvents)
 {
-	for (UINT i = 0; i < coObjects->size(); i++)
-	{
-		CScene* s = CGame::GetInstance()->GetCurrentScene();
-		if (dynamic_cast<CPlayScene*>(s))
-			if (!IsInCamera())
-				continue;
+	CScene* s = CGame::GetInstance()->GetCurrentScene();
+	if (dynamic_cast<CPlayScene*>(s))
+		if (!IsInCamera())
+			return;
 
-		LPGAMEOBJECT object = coObjects->at(i);
-		if (!dynamic_cast<CBrick*>(object) && !dynamic_cast<CRewardBox*>(object))
+	// only bricks and reward boxes stop us
+	GetNearbyObjects(coObjects, nearby);
+	UINT grounds = 0;
+	for (UINT i = 0; i < nearby.size(); i++)
+	{
+		LPGAMEOBJECT object = nearby[i];
+		if (object->kind != OBJECT_KIND_BRICK && object->kind != OBJECT_KIND_REWARD_BOX)
 			continue;
+		nearby[grounds++] = object;
+	}
+	nearby.resize(grounds);
 
+	UINT first = coEvents.size();
+	SweptAABBEx(nearby, coEvents);
 
-		LPCOLLISIONEVENT e = SweptAABBEx(object);
-
-		if (e->t > 0 && e->t <= 1.0f)
+	float mleft, mtop, mright, mbottom;
+	GetCachedBoundingBox(mleft, mtop, mright, mbottom);
+	UINT count = first;
+	for (UINT i = first; i < coEvents.size(); i++)
+	{
+		CCollisionEvent& e = coEvents[i];
+		float oleft, otop, obottom, oright;
+		e.obj->GetCachedBoundingBox(oleft, otop, oright, obottom);
+		if (e.nx != 0)
 		{
-			float mleft, mtop, mright, mbottom;
-			GetBoundingBox(mleft, mtop, mright, mbottom);
-			float oleft, otop, obottom, oright;
-			e->obj->GetBoundingBox(oleft, otop, oright, obottom);
-			if (e->nx != 0)
+			if (ceil(mbottom) == otop)
 			{
-				if (ceil(mbottom) == otop)
-				{
-					continue;
-				}
+				continue;
 			}
-			coEvents.push_back(e);
 		}
-		else
-			delete e;
+		coEvents[count++] = e;
 	}
+	coEvents.resize(count);
 
 	std::sort(coEvents.begin(), coEvents.end(), CCollisionEvent::compare);
 }
@@ -172,9 +175,9 @@ void CLifeUp::CalcPotentialCollisionWithMario()
 	if (dynamic_cast<CPlayScene*>(s))
 	{
 		mario = ((CPlayScene*)s)->GetPlayer();
-		LPCOLLISIONEVENT e = SweptAABBEx(mario);
+		CCollisionEvent e = SweptAABBEx(mario);
 
-		if (e->t > 0 && e->t <= 1.0f)
+		if (e.t > 0 && e.t <= 1.0f)
 		{
 			IsEnable = false;
 			mario->UpLife();
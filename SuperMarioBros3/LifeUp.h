@@ -30,7 +30,7 @@ public:
 	void SetState(int _state);
 
 	bool IsOnTheLeftOfMario();
-	void CalcPotentialCollisions(vector<LPGAMEOBJECT>* coObjects, vector<LPCOLLISIONEVENT>& coEvents);
+	void CalcPotentialCollisions(vector<LPGAMEOBJECT>* coObjects, vector<CCollisionEvent>& coEvents);
 
 };
 
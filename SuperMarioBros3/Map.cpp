@@ -3,6 +3,10 @@
 #include "Map.h"
 #include "Textures.h"
 #include "PlayScence.h"
+#include "Utils.h"
+#include "ObjectHeap.h"
+
+#define MAX_MAP_LINE 1024
 
 
 Map::Map(int _idMap, int _tileWidth, int _tileHeight, int _tRTileSet, int	_tCTileSet, int	_tRMap, int	_tCMap, int	_totalTiles)
@@ -16,6 +20,8 @@ Map::Map(int _idMap, int _tileWidth, int _tileHeight, int _tRTileSet, int	_tCTil
 	this->TileWidth = _tileWidth;
 	this->TotalTiles = _totalTiles;
 	this->MapHeight = this->MapWidth = 0;
+	this->DrawOffsetX = 0;
+	this->DrawOffsetY = -HUD_HEIGHT;	// the HUD takes the top of the screen in a play scene
 	Matrix = nullptr;
 }
 Map::~Map()
@@ -29,6 +35,8 @@ Map::~Map()
 		delete [] Matrix;
 		Matrix = nullptr;
 	}
+	for (size_t i = 0; i < TileColliders.size(); i++)
+		delete TileColliders[i];
 }
 
 void Map::CreateTilesFromTileSet()
@@ -49,7 +57,7 @@ void Map::LoadMatrix(LPCWSTR path)
 {
   	ifstream f;
 
-	f.open(path);
+	OpenDataFile(f, path);
 	//Init Matrix
 
 	this->Matrix = new int* [TotalRowsOfMap];
@@ -66,7 +74,112 @@ void Map::LoadMatrix(LPCWSTR path)
 	this->MapWidth = TileWidth * TotalColsOfMap;
 }
 
+/*
+	The map as chunks of MAP_CHUNK_SIZE pixels, one draw for each chunk on the screen, all
+	from the texture of the chunks drawn lately (see CMapChunkCache)
+*/
 void Map::Render()
+{
+	CGame* game = CGame::GetInstance();
+	size_t budget = game->GetMapChunkBudget();
+	if (budget == 0 || ChunksFailed)
+	{
+		RenderTiles();
+		return;
+	}
+	Chunks.SetBudget(budget);
+
+	LPTEXTURE texture = Chunks.GetTexture();
+	if (texture == NULL)
+	{
+		DebugOut(L"[INFO] The renderer makes no map chunks, tiles are drawn one by one\n");
+		ChunksFailed = true;
+		RenderTiles();
+		return;
+	}
+
+	int tilesX = MAP_CHUNK_SIZE / TileWidth, tilesY = MAP_CHUNK_SIZE / TileHeight;
+	int chunkWidth = tilesX * TileWidth, chunkHeight = tilesY * TileHeight;
+	int chunkCols = (MapWidth + chunkWidth - 1) / chunkWidth;
+	int chunkRows = (MapHeight + chunkHeight - 1) / chunkHeight;
+
+	// the screen in map pixels
+	float cx, cy;
+	game->GetCamPos(cx, cy);
+	float left = cx - DrawOffsetX, top = cy - DrawOffsetY;
+	int firstCol = max((int)floor(left / chunkWidth), 0);
+	int lastCol = min((int)floor((left + game->GetScreenWidth()) / chunkWidth), chunkCols - 1);
+	int firstRow = max((int)floor(top / chunkHeight), 0);
+	int lastRow = min((int)floor((top + game->GetScreenHeight()) / chunkHeight), chunkRows - 1);
+
+	Chunks.NextFrame();
+	for (int row = firstRow; row <= lastRow; row++)
+		for (int col = firstCol; col <= lastCol; col++)
+		{
+			bool filled;
+			int slot = Chunks.Find(col, row, filled);
+			if (slot >= 0 && !filled && !FillChunk(slot, col, row))
+			{
+				Chunks.Drop(slot);
+				slot = -1;
+			}
+
+			if (slot < 0)
+			{
+				// no room left in the cache this frame
+				DrawTiles(row * tilesY, min((row + 1) * tilesY, TotalRowsOfMap),
+					col * tilesX, min((col + 1) * tilesX, TotalColsOfMap - 1));
+				continue;
+			}
+
+			int x, y;
+			Chunks.GetSlotPosition(slot, x, y);
+			game->Draw(col * chunkWidth + DrawOffsetX, row * chunkHeight + DrawOffsetY, texture,
+				x, y, x + chunkWidth, y + chunkHeight, 255);
+		}
+}
+
+/*
+	Copy the tiles of chunk col, row from the sprites into its slot of the cache. The last
+	column of the map is left out, RenderTiles never drew it
+*/
+bool Map::FillChunk(int slot, int col, int row)
+{
+	int tilesX = MAP_CHUNK_SIZE / TileWidth, tilesY = MAP_CHUNK_SIZE / TileHeight;
+	int endCol = min((col + 1) * tilesX, TotalColsOfMap - 1);
+	int endRow = min((row + 1) * tilesY, TotalRowsOfMap);
+
+	int slotX, slotY;
+	Chunks.GetSlotPosition(slot, slotX, slotY);
+
+	ChunkCopies.clear();
+	for (int r = row * tilesY; r < endRow; r++)
+		for (int c = col * tilesX; c < endCol; c++)
+		{
+			int tile = Matrix[r][c];
+			if (tile < 1 || tile > (int)Tiles.size())
+				continue;
+
+			CAtlasCopy copy;
+			copy.source = Tiles[tile - 1]->GetTexture();
+			Tiles[tile - 1]->GetRect(copy.left, copy.top, copy.right, copy.bottom);
+			copy.x = slotX + (c - col * tilesX) * TileWidth;
+			copy.y = slotY + (r - row * tilesY) * TileHeight;
+
+			// a tile past the end of the tile set has nothing to copy
+			if (copy.source == NULL || copy.right > copy.source->width || copy.bottom > copy.source->height)
+				continue;
+			ChunkCopies.push_back(copy);
+		}
+
+	return CGame::GetInstance()->GetRenderer()->UpdateAtlas(Chunks.GetTexture(),
+		slotX, slotY, slotX + MAP_CHUNK_SIZE, slotY + MAP_CHUNK_SIZE, ChunkCopies);
+}
+
+/*
+	One draw for every tile on the screen
+*/
+void Map::RenderTiles()
 {
 	float cx, cy;
 	CGame* game = CGame::GetInstance();
@@ -83,20 +196,113 @@ void Map::Render()
 
 	if (limitCol >= TotalColsOfMap) limitCol = TotalColsOfMap - 1;
 
-	if (dynamic_cast<CPlayScene*>(game->GetCurrentScene()))
+	DrawTiles(startRow, limitRow, startCol, limitCol);
+}
+
+void Map::DrawTiles(int startRow, int limitRow, int startCol, int limitCol)
+{
+	for (int r = startRow; r < limitRow; r++)
+		for (int c = startCol; c < limitCol; c++)
+		{
+			Tiles[Matrix[r][c] - 1]->Draw(c * TileWidth + DrawOffsetX, r * TileHeight + DrawOffsetY, 255);
+		}
+}
+
+/*
+	Read the collision table of the tile set: one "tile flag" pair per line, where tile is
+	the value used in the matrix. Tiles that are not listed do not collide.
+*/
+void Map::LoadCollisionFlags(LPCWSTR path)
+{
+	ifstream f;
+	OpenDataFile(f, path);
+	if (!f)
 	{
-		for (int r = startRow; r < limitRow; r++)
-			for (int c = startCol; c < limitCol; c++)
-			{
-				Tiles[Matrix[r][c] - 1]->Draw(float(c * TileWidth), float(r * TileHeight - HUD_HEIGHT), 255);
-			}
+		DebugOut(L"[ERROR] Failed to open tile collision file %s\n", path);
+		return;
 	}
-	else
+
+	CollisionFlags.assign(TotalTiles + 1, TILE_COLLISION_NONE);
+
+	char str[MAX_MAP_LINE];
+	while (f.getline(str, MAX_MAP_LINE))
 	{
-		for (int r = startRow; r < limitRow; r++)
-			for (int c = startCol; c < limitCol; c++)
+		string line(str);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		vector<string> tokens = split(line);
+		if (tokens.size() < 2)
+			continue;
+
+		int tile = atoi(tokens[0].c_str());
+		if (tile < 0 || tile > TotalTiles)
+			continue;
+		CollisionFlags[tile] = atoi(tokens[1].c_str());
+	}
+	f.close();
+
+	TileColliders.assign(TotalRowsOfMap * TotalColsOfMap, nullptr);
+}
+
+int Map::GetCollisionFlag(int row, int col)
+{
+	if (row < 0 || row >= TotalRowsOfMap || col < 0 || col >= TotalColsOfMap)
+		return TILE_COLLISION_NONE;
+	int tile = Matrix[row][col];
+	if (tile < 0 || tile > TotalTiles)
+		return TILE_COLLISION_NONE;
+	return CollisionFlags[tile];
+}
+
+/*
+	Colliders of the tiles touched by the box (l, t, r, b). Each solid cell is a brick of
+	the matching type, kept until the map is unloaded so collision events can point at it.
+*/
+void Map::GetCollisionTiles(float l, float t, float r, float b, vector<CGameObject*>& tiles)
+{
+	if (CollisionFlags.empty())
+		return;
+
+	int startCol = (int)floor(l / TileWidth);
+	int endCol = (int)floor(r / TileWidth);
+	int startRow = (int)floor(t / TileHeight);
+	int endRow = (int)floor(b / TileHeight);
+
+	for (int row = startRow; row <= endRow; row++)
+		for (int col = startCol; col <= endCol; col++)
+		{
+			int flag = GetCollisionFlag(row, col);
+			if (flag == TILE_COLLISION_NONE)
+				continue;
+
+			CBrick*& brick = TileColliders[row * TotalColsOfMap + col];
+			if (brick == nullptr)
 			{
-				Tiles[Matrix[r][c] - 1]->Draw(float(c-1) * TileWidth, (float)r * TileHeight, 255);
+				int type = BRICK_TYPE_PLATFORM;
+				if (flag == TILE_COLLISION_BIG_BLOCK)
+					type = BRICK_TYPE_BIG_BLOCK;
+				else if (flag == TILE_COLLISION_PIPE)
+					type = BRICK_TYPE_PIPE;
+
+				brick = new CBrick((float)(col * TileWidth), (float)(row * TileHeight), type);
+				brick->SetPosition((float)(col * TileWidth), (float)(row * TileHeight));
+				brick->SetSpeed(0, 0);
+				brick->RefreshBoundingBox();
+				CObjectHeap::SetCached(brick);		// a snapshot restored later must not take it away
 			}
-	}
-}
\ No newline at end of file
+			tiles.push_back(brick);
+		}
+}
+
+/*
+	TILE_COLLISION_ flag of every cell of a window of the matrix, row by row. Cells off the
+	map do not collide
+*/
+void Map::GetCollisionWindow(int firstRow, int firstCol, int rows, int cols, BYTE* flags)
+{
+	for (int row = 0; row < rows; row++)
+		for (int col = 0; col < cols; col++)
+			flags[row * cols + col] = CollisionFlags.empty() ? TILE_COLLISION_NONE :
+				(BYTE)GetCollisionFlag(firstRow + row, firstCol + col);
+}
@@ -1,8 +1,16 @@
 #pragma once
-#include <d3dx9.h>
-#include <d3d9.h>
 #include <vector>
 #include "Sprites.h"
+#include "MapChunkCache.h"
+
+// collision flag of a tile of the tile set, same meaning as the brick types
+#define TILE_COLLISION_NONE			0
+#define TILE_COLLISION_SOLID		1
+#define TILE_COLLISION_BIG_BLOCK	2
+#define TILE_COLLISION_PIPE			3
+
+class CGameObject;
+class CBrick;
 
 class Map
 {
@@ -13,17 +21,41 @@ private:
 	int TotalTiles;
 	int TileWidth, TileHeight;
 	int MapWidth, MapHeight;
-	LPDIRECT3DTEXTURE9 TileSet;
+	LPTEXTURE TileSet;
 	vector<LPSPRITE> Tiles;
 
+	// collision flag of every tile value of the matrix, empty when the map has no collision table
+	vector<int> CollisionFlags;
+	// one brick per solid cell of the matrix, created the first time a query touches it
+	vector<CBrick*> TileColliders;
+
+	int GetCollisionFlag(int row, int col);
+
+	// where map pixel 0, 0 is drawn in the scene
+	float DrawOffsetX, DrawOffsetY;
+
+	// the tiles drawn MAP_CHUNK_SIZE pixels square at a time, copied into a cache on demand
+	CMapChunkCache Chunks;
+	bool ChunksFailed = false;		// the renderer cannot make the cache, tiles are drawn one by one
+	vector<CAtlasCopy> ChunkCopies;
+
+	bool FillChunk(int slot, int col, int row);
+	void RenderTiles();
+	void DrawTiles(int startRow, int limitRow, int startCol, int limitCol);
 
 public:
 	Map(int idMap, int _tileWidth, int _tileHeight, int _tRTileSet, int	_tCTileSet, int	_tRMap, int	_tCMap, int	_totalTiles);
 	~Map();
 	void CreateTilesFromTileSet();
 	void LoadMatrix(LPCWSTR path);
+	void LoadCollisionFlags(LPCWSTR path);
+	bool HasCollision() { return !CollisionFlags.empty(); }
+	void GetCollisionTiles(float l, float t, float r, float b, vector<CGameObject*>& tiles);
+	void GetCollisionWindow(int firstRow, int firstCol, int rows, int cols, BYTE* flags);
 	void Render();
 	void Draw(float x, float y);
+	void SetDrawOffset(float x, float y) { DrawOffsetX = x; DrawOffsetY = y; }
+	CMapChunkCache* GetChunkCache() { return &Chunks; }
 
 	int GetTotalColsOfMap() { return this->TotalColsOfMap; }
 	int GetTotalRowsOfMap() { return this->TotalRowsOfMap; }
@@ -31,4 +63,5 @@ public:
 	int GetTileHeight() { return this->TileHeight; }
 	int GetMapHeight() { return this->MapHeight; }
 	int GetMapWidth() { return this->MapWidth; }
+	vector<LPSPRITE>& GetTiles() { return Tiles; }
 };
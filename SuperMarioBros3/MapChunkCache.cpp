@@ -0,0 +1,81 @@
+#include "MapChunkCache.h"
+#include "Game.h"
+
+void CMapChunkCache::Clear()
+{
+	delete texture;
+	texture = NULL;
+	slots.clear();
+}
+
+void CMapChunkCache::SetBudget(size_t bytes)
+{
+	if (bytes == budget)
+		return;
+	budget = bytes;
+	Clear();
+}
+
+LPTEXTURE CMapChunkCache::GetTexture()
+{
+	if (texture != NULL)
+		return texture;
+
+	int count = max((int)(budget / MAP_CHUNK_BYTES), 1);
+	int cols = min(count, MAP_CHUNK_SLOTS_PER_ROW);
+	int rows = (count + cols - 1) / cols;
+
+	CMapChunkSlot free = { -1, -1, 0 };
+	slots.assign(count, free);
+
+	vector<CAtlasCopy> none;
+	texture = CGame::GetInstance()->GetRenderer()->CreateAtlas(cols * MAP_CHUNK_SIZE, rows * MAP_CHUNK_SIZE, none);
+	return texture;
+}
+
+int CMapChunkCache::Find(int col, int row, bool& filled)
+{
+	int oldest = -1;
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		if (slots[i].col == col && slots[i].row == row)
+		{
+			slots[i].lastUsed = frame;
+			stats.hits++;
+			filled = true;
+			return (int)i;
+		}
+		if (slots[i].lastUsed != frame && (oldest < 0 || slots[i].lastUsed < slots[oldest].lastUsed))
+			oldest = (int)i;
+	}
+
+	filled = false;
+	if (oldest < 0)
+	{
+		stats.overflows++;
+		return -1;
+	}
+
+	if (slots[oldest].col != -1)
+		stats.evictions++;
+	stats.misses++;
+	slots[oldest].col = col;
+	slots[oldest].row = row;
+	slots[oldest].lastUsed = frame;
+	return oldest;
+}
+
+void CMapChunkCache::GetSlotPosition(int slot, int& x, int& y)
+{
+	x = slot % MAP_CHUNK_SLOTS_PER_ROW * MAP_CHUNK_SIZE;
+	y = slot / MAP_CHUNK_SLOTS_PER_ROW * MAP_CHUNK_SIZE;
+}
+
+int CMapChunkCache::GetCount()
+{
+	int count = 0;
+	for (size_t i = 0; i < slots.size(); i++)
+		if (slots[i].col != -1)
+			count++;
+	return count;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include "Renderer.h"
+
+using namespace std;
+
+#define MAP_CHUNK_SIZE			256					// width and height of a chunk in pixels
+#define MAP_CHUNK_BYTES			(MAP_CHUNK_SIZE * MAP_CHUNK_SIZE * 4)
+#define MAP_CHUNK_CACHE_BUDGET	(4 * 1024 * 1024)	// bytes of chunks kept, 16 chunks
+#define MAP_CHUNK_SLOTS_PER_ROW	8					// the cache texture is at most 2048 wide
+
+struct CMapChunkStats
+{
+	ULONGLONG hits = 0;			// chunks drawn from the cache
+	ULONGLONG misses = 0;		// chunks that had to be made
+	ULONGLONG evictions = 0;	// chunks dropped for another one
+	ULONGLONG overflows = 0;	// chunks drawn tile by tile, every slot was drawn in the frame
+};
+
+struct CMapChunkSlot
+{
+	int col, row;				// chunk in the slot, in the grid of chunks of the map, -1 when free
+	ULONGLONG lastUsed;			// frame it was last drawn in
+};
+
+/*
+	The chunks of a map that were drawn lately, side by side in the slots of one texture so
+	the map draws without switching textures. Past the budget the least recently drawn chunk
+	gives its slot up, but never one drawn in the current frame: the renderer may not have
+	drawn it yet.
+*/
+class CMapChunkCache
+{
+	LPTEXTURE texture = NULL;
+	vector<CMapChunkSlot> slots;
+	size_t budget = MAP_CHUNK_CACHE_BUDGET;
+	ULONGLONG frame = 0;
+	CMapChunkStats stats;
+
+public:
+	~CMapChunkCache() { Clear(); }
+
+	void Clear();
+	// drops the chunks when the number of slots changes
+	void SetBudget(size_t bytes);
+
+	// the texture of the slots, made on the first call. NULL when the renderer cannot
+	LPTEXTURE GetTexture();
+
+	// chunks drawn after this are of the new frame
+	void NextFrame() { frame++; }
+
+	// slot holding chunk col, row. On a miss it is given the least recently drawn slot
+	// and filled is false, the caller copies the chunk in. -1 when every slot is in use
+	int Find(int col, int row, bool& filled);
+	// the chunk could not be copied into its slot
+	void Drop(int slot) { slots[slot].col = slots[slot].row = -1; }
+	void GetSlotPosition(int slot, int& x, int& y);
+
+	int GetCount();
+	size_t GetBytes() { return texture == NULL ? 0 : slots.size() * MAP_CHUNK_BYTES; }
+	const CMapChunkStats& GetStats() { return stats; }
+};
@@ -4,6 +4,7 @@
 
 #include "Mario.h"
 #include "Game.h"
+#include "Snapshot.h"
 
 #include "Goomba.h"
 #include "Portal.h"
@@ -23,11 +24,14 @@ using namespace  std;
 
 CMario::CMario(float x, float y) : CGameObject()
 {
+	kind = OBJECT_KIND_MARIO;
 	level = MARIO_LEVEL_SMALL;
 	type = MARIO;
 	money = 0;
 	typeCard = new int[3]{ 0,0,0 };
 	untouchable = 0;
+	untouchableTimer = throwFireTimer = swingTailTimer = kickTimer = TIMER_NONE;
+	fallSlowlyTimer = canFlyHighTimer = transformTimer = bonkTimer = TIMER_NONE;
 	SetState(MARIO_STATE_IDLE);
 	changeImminent_start = 0;
 
@@ -113,47 +117,63 @@ void CMario::Calculate_vy(DWORD _dt)
 			vy = MARIO_MAX_FALL_SPEED;
 	}
 }
-void CMario::UpdateFlagBaseOnTime()
+/*
+	Timer callbacks, each one ends a flag raised by the matching Start function
+*/
+void CMario::EndUntouchable()
 {
-	// reset untouchable timer if untouchable time has passed
-	if (state != MARIO_STATE_DIE)
-	{
-		if (GetTickCount64() - untouchable_start > MARIO_UNTOUCHABLE_TIME)
-		{
-			untouchable_start = 0;
-			untouchable = 0;
-		}
-	}
-	if (GetTickCount64() - throwFire_start > MARIO_PERFORM_THROW_TIME)
-		IsThrowing = false;
-
-	if (GetTickCount64() - swingTail_start > MARIO_PERFORM_SWING_TAIL_TIME && IsSwingTail)
-	{
-		IsSwingTail = false;
-		if (nx > 0)
-			x += 2;
-		else
-			x += 7;
-	}
-
-	if (GetTickCount64() - kick_start > MARIO_KICKING_TIME && IsKicking)
-		IsKicking = false;
-
-	if (GetTickCount64() - fallSlowly_start > MARIO_FALLING_SLOWLY_TIME)
-		IsFallingSlowly = false;
-	if (GetTickCount64() - canFlyHigh_start > MARIO_RACCOON_CAN_FLY_TIME)
-		IsRaccoonCanFlyHigh = false;
-	if (GetTickCount64() - transform_start > MARIO_TRANSFORM_TIME && IsTransforming)
-	{
+	// stays untouchable while dying
+	if (state == MARIO_STATE_DIE)
+		return;
+	untouchable_start = 0;
+	untouchable = 0;
+}
+void CMario::EndThrowFire()
+{
+	IsThrowing = false;
+}
+void CMario::EndSwingTail()
+{
+	if (!IsSwingTail)
+		return;
+	IsSwingTail = false;
+	if (nx > 0)
+		x += 2;
+	else
+		x += 7;
+}
+void CMario::EndKick()
+{
+	IsKicking = false;
+}
+void CMario::EndFallSlowly()
+{
+	IsFallingSlowly = false;
+}
+void CMario::EndCanFlyHigh()
+{
+	IsRaccoonCanFlyHigh = false;
+}
+void CMario::EndTransform()
+{
+	if (IsTransforming)
 		IsTransforming = false;
-	}
-	else if (GetTickCount64() - transform_start > MARIO_GROWING_TIME && IsGrowing)
+	else if (IsGrowing)
 		IsGrowing = false;
-	if (GetTickCount64() - bonk_start > MARIO_BONK_TIME && IsBonk)
-	{
-		IsBonk = false;
-		IsLookingUp = true;
-	}
+}
+void CMario::EndBonk()
+{
+	if (!IsBonk)
+		return;
+	IsBonk = false;
+	IsLookingUp = true;
+}
+void CMario::StartTransformTimer()
+{
+	if (IsTransforming)
+		StartTimer(transformTimer, MARIO_TRANSFORM_TIME, (LPTIMERCALLBACK)&CMario::EndTransform);
+	else if (IsGrowing)
+		StartTimer(transformTimer, MARIO_GROWING_TIME, (LPTIMERCALLBACK)&CMario::EndTransform);
 }
 void CMario::UpdateBullets(DWORD _dt, vector<LPGAMEOBJECT>* coObjects)
 {
@@ -162,7 +182,7 @@ void CMario::UpdateBullets(DWORD _dt, vector<LPGAMEOBJECT>* coObjects)
 		CBullet_Mario* bullet = (CBullet_Mario*)Bullets[i];
 		if (bullet->GetState() != BULLET_STATE_EXPLODING)
 			bullet->Update(_dt, coObjects);
-		else if (GetTickCount64() - bullet->GetStartExplode_time() > BULLET_MARIO_EXPLOSION_TIME)
+		else if (CGame::GetInstance()->GetSceneTime() - bullet->GetStartExplode_time() > BULLET_MARIO_EXPLOSION_TIME)
 		{
 			//CGameObject* bul = Bullets[i];
 			Bullets.erase(Bullets.begin() + i);
@@ -178,10 +198,7 @@ void CMario::Update(DWORD dt, vector<LPGAMEOBJECT> *coObjects)
 	UpdateBullets(dt, coObjects);
 	Calculate_vy(dt);
 	Calculate_vx(dt);
-	UpdateFlagBaseOnTime();
 
-	vector<LPCOLLISIONEVENT> coEvents;
-	vector<LPCOLLISIONEVENT> coEventsResult;
 	coEvents.clear();
 
 	// turn off collision when die 
@@ -238,215 +255,9 @@ void CMario::Update(DWORD dt, vector<LPGAMEOBJECT> *coObjects)
 
 		float mleft, mtop, mright, mbottom;
 		GetBoundingBox(mleft, mtop, mright, mbottom);
+		CCollisionContext c(min_tx, min_ty, nx, ny, x0, y0);
 		for (UINT i = 0; i < coEventsResult.size(); i++)
-		{
-			LPCOLLISIONEVENT e = coEventsResult[i];
-			if (dynamic_cast<CBrick*>(e->obj))
-			{
-				CBrick* brick = dynamic_cast<CBrick*>(e->obj);
-				switch (brick->GetType())
-				{
-				case BRICK_TYPE_PLATFORM:
-				case BRICK_TYPE_PIPE:
-					BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-					break;
-				case BRICK_TYPE_BIG_BLOCK:
-				{
-					if (e->ny == -1)
-					{
-						BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-					}
-					else
-					{
-						x = x0 + dx;
-						y = y0 + dy;
-					}
-					break;
-				}
-				}
-				if (IsReadyDucking)
-				{
-					Duck();
-				}
-			}
-			else if(dynamic_cast<CRewardBox*>(e->obj))
-			{
-				CRewardBox* box = dynamic_cast<CRewardBox*>(e->obj);
-				BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-				if (e->ny == 1)
-				{
-					box->BeAttacked();
-				}
-			}
-			else if(dynamic_cast<CGoomba*>(e->obj))
-			{
-				CGoomba* goomba = dynamic_cast<CGoomba*>(e->obj);
-				// jump on top >> kill Goomba and deflect a bit 
-				if (e->ny != 0)
-				{
-					if (e->ny < 0)
-					{
-						BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-						if (goomba->GetState() != GOOMBA_STATE_DIE_Y)
-						{
-							goomba->BeDamaged_Y();
- 							vy = -MARIO_JUMP_DEFLECT_SPEED;
-							IsJumping = true;
-							ny = -1;
-						}
-					}
-					else
-					{
-						if (untouchable == 0)
-								BeDamaged();
-					}
-				}
-				else if (e->nx != 0)
-				{
-					if (untouchable == 0)
-						if (!IsSwingTail)
-							BeDamaged();
-						else
-							goomba->SetState(GOOMBA_STATE_DIE_X);
-				}
-			}
-			else if (dynamic_cast<CKoopa_Small*>(e->obj))
-			{
-				CKoopa_Small* koopa = dynamic_cast<CKoopa_Small*>(e->obj);
-				if (e->nx != 0)
-				{
-					if (koopa->state == KOOPA_SMALL_STATE_IDLE) //holdable when turtoiseshell Idle
-					{
-						if (IsReadyHolding == true)
-						{
-							IsHolding = true;
-							koopa->IsBeingHeld = true;
-							koopa->SetHolder(this);
-							//koopa->SetState(KOOPA_SMALL_STATE_IDLE);
-							IsReadyHolding = false;
-						}
-						else
-						{
-							StartKick();
-							koopa->BeKicked(this->nx);
-						}
-					}
-					else //die when turtoiseshell run
-					{
-						if (untouchable == 0)
-							BeDamaged();
-					}
-				}
-				if (e->ny != 0)
-				{
-					if (e->ny < 0)
-					{
-						koopa->BeDamaged_Y();
-						vy = -MARIO_JUMP_DEFLECT_SPEED;
-						IsJumping = true;
-						ny = -1;
-					}
-					else
-					{
-						if (koopa->GetType() == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || koopa->GetType() == KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
-						{
-							koopa->vy = -KOOPA_SPEED_TURTOISESHELL_DEFLECT_Y;
-							koopa->vx = -KOOPA_SPEED_TURTOISESHELL_DEFLECT_X;
-							IsBonk = true;
-							bonk_start =(DWORD) GetTickCount64();
-							SetState(MARIO_STATE_IDLE);
-						}
-						else if (untouchable == 0)
-							this->BeDamaged();
-					}
-				}
-			}
-			else if (dynamic_cast<CPlant*>(e->obj))
-			{
-				if (untouchable == 0)
-					BeDamaged();
-			}
-			else if (dynamic_cast<CMario*>(e->obj))
-			{
-				if (type == LUIGI)
-				{
-					if (e->ny < 0) // for luigi
-					{
-						BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-						vy = -LUIGI_JUMP_DEFLECT_SPEED;
-						IsJumping = true;
-						ny = -1;
-					}
-				}
-				else //if(type == MARIO)
-				{
-					if (e->ny > 0)
-					{
-						SetState(MARIO_STATE_IDLE);
-						ax = 0;
-						vx = 0;
-						Duck();
-					}
-				}
-			}
-			else if (dynamic_cast<CItem*>(e->obj))
-			{
-				CItem* item = (CItem*)e->obj;
-				if (item->IsIntact)
-				{
-					item->BeTaken();
-					AddCard(item->GetType());
-					CPlayScene* s = (CPlayScene*)CGame::GetInstance()->GetCurrentScene();
-					CEndSceneNotification* noti = new CEndSceneNotification(item->x - 3 * ITEM_BBOX_WIDTH, item->y - 4 * ITEM_BBOX_HEIGHT);
-					s->SetNoti(noti);
-				}
-			}
-			else if (dynamic_cast<CPortal*>(e->obj))
-			{
-				BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-
-				if (e->ny !=0)
-				{
-					CPortal* p = dynamic_cast<CPortal*>(e->obj);
-					if (p->GetType() == PORTAL_TYPE_PASSIVE)
-					{
-						if (this->state == MARIO_STATE_BEND_DOWN)
-						{
-							//IsEnteringDrain = true;
-							CPlayScene* scene = (CPlayScene*)CGame::GetInstance()->GetCurrentScene();
-							scene->TransferZone(p);
-						}
-					}
-					else
-					{
-						CPlayScene* scene = (CPlayScene*)CGame::GetInstance()->GetCurrentScene();
-						scene->TransferZone(p);
-					}
-				}
-			}
-			else if (dynamic_cast<CMovingPlatform*>(e->obj))
-			{
-			if (e->ny < 0)
-			{
-				IsTouchingGround = true;
-				CMovingPlatform* mPlatform = dynamic_cast<CMovingPlatform*>(e->obj);
-				mPlatform->SetState(MPLATFORM_STATE_FALLING);
-				mPlatform->isBeingTouched = true;
-				BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-			}
-			else if (e->nx != 0)
-			{
-				if (e->obj->vx < 0)
-					vx = -0.0000001f;
-			}
-			else if (e->ny > 0)
-			{
-				BasicCollision(min_tx, min_ty, e->nx, e->ny, x0, y0);
-			}
-
-			}
-
-		}
+			RespondToCollision(coEventsResult[i], c);
 		
 	}
 
@@ -459,9 +270,6 @@ void CMario::Update(DWORD dt, vector<LPGAMEOBJECT> *coObjects)
 			IsFalling = true;
 		}
 	}
-	// clean up collision events
-	for (UINT i = 0; i < coEvents.size(); i++) 
-		delete coEvents[i];
 }
 void CMario::BasicCollision(float min_tx, float min_ty, float _nx, float _ny, float x0, float y0)
 {
@@ -981,7 +789,7 @@ void CMario::Render()
 	//Render Bullet
 	for (int i = 0; (unsigned)i < Bullets.size(); i++)
 	{
-		Bullets[i]->Render();
+		Bullets[i]->RenderInterpolated();
 	}
 }
 void CMario::SetState(int _state)
@@ -1105,7 +913,7 @@ void CMario::Reset()
 }
 void CMario::StartThrowFire()
 {
-	if (GetTickCount64() - throwFire_start >= MARIO_THROWING_TIME)
+	if (CGame::GetInstance()->GetSceneTime() - throwFire_start >= MARIO_THROWING_TIME)
 	{
 
 		IsThrowing = true;
@@ -1118,7 +926,8 @@ void CMario::StartThrowFire()
 		bullet->vx =  this->nx * BULLET_MARIO_SPEED_X;
 		bullet->vy = BULLET_MARIO_FIRST_SPEED_Y;
 		Bullets.push_back(bullet);
-		throwFire_start = (DWORD)GetTickCount64();
+		throwFire_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+		StartTimer(throwFireTimer, MARIO_PERFORM_THROW_TIME, (LPTIMERCALLBACK)&CMario::EndThrowFire);
 	}
 }
 void CMario::upImminent()
@@ -1127,7 +936,7 @@ void CMario::upImminent()
 	{
 		if (abs(vx) >= MARIO_WALKING_SPEED_MAX - 0.001)
 		{
-			if (GetTickCount64() - changeImminent_start >= MARIO_CHANGE_IMMINENT_TIME)
+			if (CGame::GetInstance()->GetSceneTime() - changeImminent_start >= MARIO_CHANGE_IMMINENT_TIME)
 			{
 				imminentStack++;
 				if (imminentStack > MARIO_MAX_IMMINENT_STACKS - 1)
@@ -1135,36 +944,37 @@ void CMario::upImminent()
 					imminentStack = MARIO_MAX_IMMINENT_STACKS;
 					IsRunning = true;
 				}
-				changeImminent_start = (DWORD)GetTickCount64();
+				changeImminent_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 			}
 		}
 	}
-	else if (GetTickCount64() - canFlyHigh_start <= MARIO_RACCOON_CAN_FLY_TIME)
+	else if (CGame::GetInstance()->GetSceneTime() - canFlyHigh_start <= MARIO_RACCOON_CAN_FLY_TIME)
 	{
 		imminentStack = MARIO_MAX_IMMINENT_STACKS;
 	}
 }
 void CMario::downImminent()
 {
-	if (GetTickCount64() - canFlyHigh_start <= MARIO_RACCOON_CAN_FLY_TIME)
+	if (CGame::GetInstance()->GetSceneTime() - canFlyHigh_start <= MARIO_RACCOON_CAN_FLY_TIME)
 	{
 		imminentStack = MARIO_MAX_IMMINENT_STACKS -1;
 	}
-	else if (GetTickCount64() - changeImminent_start >= MARIO_CHANGE_IMMINENT_TIME)
+	else if (CGame::GetInstance()->GetSceneTime() - changeImminent_start >= MARIO_CHANGE_IMMINENT_TIME)
 	{
 		imminentStack--;
 		if (imminentStack < 0)
 			imminentStack = 0;
-		changeImminent_start = (DWORD)GetTickCount64();
+		changeImminent_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 	}
 	IsRunning = false;
 }
 void CMario::StartSwingTail()
 {
-	if (GetTickCount64() - swingTail_start >= MARIO_SWING_TAIL_TIME)
+	if (CGame::GetInstance()->GetSceneTime() - swingTail_start >= MARIO_SWING_TAIL_TIME)
 	{
 		IsSwingTail = true;
-		swingTail_start = (DWORD)GetTickCount64();
+		swingTail_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+		StartTimer(swingTailTimer, MARIO_PERFORM_SWING_TAIL_TIME, (LPTIMERCALLBACK)&CMario::EndSwingTail);
 		StageOfSwingTail = 0;
 		if (nx > 0)
 			x -= 2;
@@ -1172,9 +982,15 @@ void CMario::StartSwingTail()
 			x -= 7;
 	}
 }
+void CMario::StartUntouchable()
+{
+	untouchable = 1;
+	untouchable_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+	StartTimer(untouchableTimer, MARIO_UNTOUCHABLE_TIME, (LPTIMERCALLBACK)&CMario::EndUntouchable);
+}
 void CMario::BeDamaged()
 {
-	transform_start = (DWORD)GetTickCount64();
+	transform_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 	switch (level)
 	{
 	case MARIO_LEVEL_SMALL:
@@ -1195,11 +1011,12 @@ void CMario::BeDamaged()
 		IsTransforming = true;
 		break;
 	}
+	StartTransformTimer();
 }
 void CMario::UpLevel()
 {
 	//SetState(MARIO_STATE_IDLE);
-	transform_start = (DWORD)GetTickCount64();
+	transform_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 	CScene* s = CGame::GetInstance()->GetCurrentScene();
 
 	switch (level)
@@ -1217,16 +1034,19 @@ void CMario::UpLevel()
 	case MARIO_LEVEL_RACCOON:
 		break;
 	}
+	StartTransformTimer();
 }
 void CMario::SlowFall()
 {
 		IsFallingSlowly = true;
-		fallSlowly_start = (DWORD)GetTickCount64();
+		fallSlowly_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+		StartTimer(fallSlowlyTimer, MARIO_FALLING_SLOWLY_TIME, (LPTIMERCALLBACK)&CMario::EndFallSlowly);
 }
 void CMario::RaccoonStartFlyHigh()
 {
 	IsRaccoonCanFlyHigh = true;
-	canFlyHigh_start = (DWORD)GetTickCount64();
+	canFlyHigh_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+	StartTimer(canFlyHighTimer, MARIO_RACCOON_CAN_FLY_TIME, (LPTIMERCALLBACK)&CMario::EndCanFlyHigh);
 }
 bool CMario::IsRaccoonReadyFly()
 {
@@ -1237,7 +1057,8 @@ bool CMario::IsRaccoonReadyFly()
 void CMario::StartKick()
 {
 	IsKicking = true;
-	kick_start = (DWORD)GetTickCount64();
+	kick_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+	StartTimer(kickTimer, MARIO_KICKING_TIME, (LPTIMERCALLBACK)&CMario::EndKick);
 }
 void CMario::AddCard(int  card)
 {
@@ -1267,4 +1088,252 @@ void CMario::StandUp()
 		IsReadyDucking = false;
 		y = y - MARIO_BIG_BBOX_HEIGHT + MARIO_BBOX_DUCKING_HEIGHT;
 	}
-}
\ No newline at end of file
+}
+
+void CMario::RegisterCollisionResponses()
+{
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_BRICK, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithBrick);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_REWARD_BOX, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithRewardBox);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_GOOMBA, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithGoomba);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_KOOPA, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithKoopa);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_PLANT, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithPlant);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_MARIO, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithMario);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_ITEM, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithItem);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_PORTAL, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithPortal);
+	SetCollisionResponse(OBJECT_KIND_MARIO, OBJECT_KIND_MOVING_PLATFORM, (LPCOLLISIONRESPONSE)&CMario::OnCollisionWithMovingPlatform);
+}
+
+void CMario::OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CBrick* brick = (CBrick*)e->obj;
+	switch (brick->GetType())
+	{
+	case BRICK_TYPE_PLATFORM:
+	case BRICK_TYPE_PIPE:
+		BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+		break;
+	case BRICK_TYPE_BIG_BLOCK:
+	{
+		if (e->ny == -1)
+		{
+			BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+		}
+		else
+		{
+			x = c.x0 + dx;
+			y = c.y0 + dy;
+		}
+		break;
+	}
+	}
+	if (IsReadyDucking)
+	{
+		Duck();
+	}
+}
+
+void CMario::OnCollisionWithRewardBox(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CRewardBox* box = (CRewardBox*)e->obj;
+	BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+	if (e->ny == 1)
+	{
+		box->BeAttacked();
+	}
+}
+
+void CMario::OnCollisionWithGoomba(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CGoomba* goomba = (CGoomba*)e->obj;
+	// jump on top >> kill Goomba and deflect a bit 
+	if (e->ny != 0)
+	{
+		if (e->ny < 0)
+		{
+			BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+			if (goomba->GetState() != GOOMBA_STATE_DIE_Y)
+			{
+				goomba->BeDamaged_Y();
+				vy = -MARIO_JUMP_DEFLECT_SPEED;
+				IsJumping = true;
+				c.ny = -1;
+			}
+		}
+		else
+		{
+			if (untouchable == 0)
+				BeDamaged();
+		}
+	}
+	else if (e->nx != 0)
+	{
+		if (untouchable == 0)
+			if (!IsSwingTail)
+				BeDamaged();
+			else
+				goomba->SetState(GOOMBA_STATE_DIE_X);
+	}
+}
+
+void CMario::OnCollisionWithKoopa(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CKoopa_Small* koopa = (CKoopa_Small*)e->obj;
+	if (e->nx != 0)
+	{
+		if (koopa->state == KOOPA_SMALL_STATE_IDLE) //holdable when turtoiseshell Idle
+		{
+			if (IsReadyHolding == true)
+			{
+				IsHolding = true;
+				koopa->IsBeingHeld = true;
+				koopa->SetHolder(this);
+				//koopa->SetState(KOOPA_SMALL_STATE_IDLE);
+				IsReadyHolding = false;
+			}
+			else
+			{
+				StartKick();
+				koopa->BeKicked(this->nx);
+			}
+		}
+		else //die when turtoiseshell run
+		{
+			if (untouchable == 0)
+				BeDamaged();
+		}
+	}
+	if (e->ny != 0)
+	{
+		if (e->ny < 0)
+		{
+			koopa->BeDamaged_Y();
+			vy = -MARIO_JUMP_DEFLECT_SPEED;
+			IsJumping = true;
+			c.ny = -1;
+		}
+		else
+		{
+			if (koopa->GetType() == KOOPA_SMALL_TYPE_GREEN_TURTOISESHELL || koopa->GetType() == KOOPA_SMALL_TYPE_RED_TURTOISESHELL)
+			{
+				koopa->vy = -KOOPA_SPEED_TURTOISESHELL_DEFLECT_Y;
+				koopa->vx = -KOOPA_SPEED_TURTOISESHELL_DEFLECT_X;
+				IsBonk = true;
+				bonk_start =(DWORD) CGame::GetInstance()->GetSceneTime();
+				StartTimer(bonkTimer, MARIO_BONK_TIME, (LPTIMERCALLBACK)&CMario::EndBonk);
+				SetState(MARIO_STATE_IDLE);
+			}
+			else if (untouchable == 0)
+				this->BeDamaged();
+		}
+	}
+}
+
+void CMario::OnCollisionWithPlant(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	if (untouchable == 0)
+		BeDamaged();
+}
+
+void CMario::OnCollisionWithMario(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	if (type == LUIGI)
+	{
+		if (e->ny < 0) // for luigi
+		{
+			BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+			vy = -LUIGI_JUMP_DEFLECT_SPEED;
+			IsJumping = true;
+			c.ny = -1;
+		}
+	}
+	else //if(type == MARIO)
+	{
+		if (e->ny > 0)
+		{
+			SetState(MARIO_STATE_IDLE);
+			ax = 0;
+			vx = 0;
+			Duck();
+		}
+	}
+}
+
+void CMario::OnCollisionWithItem(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	CItem* item = (CItem*)e->obj;
+	if (item->IsIntact)
+	{
+		item->BeTaken();
+		AddCard(item->GetType());
+		CPlayScene* s = (CPlayScene*)CGame::GetInstance()->GetCurrentScene();
+		CEndSceneNotification* noti = new CEndSceneNotification(item->x - 3 * ITEM_BBOX_WIDTH, item->y - 4 * ITEM_BBOX_HEIGHT);
+		s->SetNoti(noti);
+	}
+}
+
+void CMario::OnCollisionWithPortal(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+
+	if (e->ny !=0)
+	{
+		CPortal* p = (CPortal*)e->obj;
+		if (p->GetType() == PORTAL_TYPE_PASSIVE)
+		{
+			if (this->state == MARIO_STATE_BEND_DOWN)
+			{
+				//IsEnteringDrain = true;
+				CPlayScene* scene = (CPlayScene*)CGame::GetInstance()->GetCurrentScene();
+				scene->TransferZone(p);
+			}
+		}
+		else
+		{
+			CPlayScene* scene = (CPlayScene*)CGame::GetInstance()->GetCurrentScene();
+			scene->TransferZone(p);
+		}
+	}
+}
+
+void CMario::OnCollisionWithMovingPlatform(LPCOLLISIONEVENT e, CCollisionContext& c)
+{
+	if (e->ny < 0)
+	{
+		IsTouchingGround = true;
+		CMovingPlatform* mPlatform = (CMovingPlatform*)e->obj;
+		mPlatform->SetState(MPLATFORM_STATE_FALLING);
+		mPlatform->isBeingTouched = true;
+		BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+	}
+	else if (e->nx != 0)
+	{
+		if (e->obj->vx < 0)
+			vx = -0.0000001f;
+	}
+	else if (e->ny > 0)
+	{
+		BasicCollision(c.min_tx, c.min_ty, e->nx, e->ny, c.x0, c.y0);
+	}
+}
+
+// the cards live in their own array, outside the bytes of the object
+void CMario::SaveContainers(CSnapshot& s)
+{
+	CGameObject::SaveContainers(s);
+	s.WriteVector(Bullets);
+	s.Write(typeCard, 3 * sizeof(int));
+}
+
+void CMario::ReleaseContainers()
+{
+	CGameObject::ReleaseContainers();
+	vector<LPGAMEOBJECT>().swap(Bullets);
+}
+
+void CMario::LoadContainers(CSnapshot& s)
+{
+	CGameObject::LoadContainers(s);
+	new (&Bullets) vector<LPGAMEOBJECT>();
+	s.ReadVector(Bullets);
+	s.Read(typeCard, 3 * sizeof(int));
+}
@@ -211,15 +211,34 @@ class CMario : public CGameObject
 	DWORD canFlyHigh_start;
 	DWORD transform_start;
 	DWORD bonk_start;
+
+	// timers of the scene's timer wheel that end the flags above
+	int untouchableTimer;
+	int throwFireTimer;
+	int swingTailTimer;
+	int kickTimer;
+	int fallSlowlyTimer;
+	int canFlyHighTimer;
+	int transformTimer;
+	int bonkTimer;
  
 	int jumpStack;
 	int imminentStack;
 	int StageOfSwingTail;
 	void Calculate_vx(DWORD _dt);
 	void Calculate_vy(DWORD _dt);
-	void UpdateFlagBaseOnTime();
 	void UpdateBullets(DWORD dt, vector<LPGAMEOBJECT>* coObjects);
 
+	void EndUntouchable();
+	void EndThrowFire();
+	void EndSwingTail();
+	void EndKick();
+	void EndFallSlowly();
+	void EndCanFlyHigh();
+	void EndTransform();
+	void EndBonk();
+	void StartTransformTimer();
+
 public: 
 	bool IsReadyJump;
 	bool IsReadyHolding;
@@ -253,10 +272,13 @@ public:
 	virtual void Update(DWORD dt, vector<LPGAMEOBJECT> *colliable_objects = NULL);
 	virtual void Render();
 	virtual void GetBoundingBox(float& left, float& top, float& right, float& bottom);
+	virtual void SaveContainers(CSnapshot& s);
+	virtual void ReleaseContainers();
+	virtual void LoadContainers(CSnapshot& s);
 
 	void SetState(int state);
 	void SetLevel(int l) { level = l; }
-	void StartUntouchable() { untouchable = 1; untouchable_start =(DWORD) GetTickCount64(); }
+	void StartUntouchable();
 	void SetJumpStack(int _num) { jumpStack = _num; }
 
 
@@ -295,4 +317,15 @@ public:
 	void UpLevel();
 	void Duck();
 	void StandUp();
+
+	static void RegisterCollisionResponses();
+	void OnCollisionWithBrick(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithRewardBox(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithGoomba(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithKoopa(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithPlant(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithMario(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithItem(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithPortal(LPCOLLISIONEVENT e, CCollisionContext& c);
+	void OnCollisionWithMovingPlatform(LPCOLLISIONEVENT e, CCollisionContext& c);
 };
\ No newline at end of file
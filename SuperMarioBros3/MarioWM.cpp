@@ -1,4 +1,5 @@
 #include "MarioWM.h"
+#include "Game.h"
 #include "Utils.h"
 
 CMarioWM::CMarioWM(float _x , float _y ):CGameObject::CGameObject()
@@ -15,11 +16,9 @@ void CMarioWM::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 {
 	CGameObject::Update(dt, coObjects);
 
-	if (IsBeingPrevented && GetTickCount64() - bePrevented_start > MARIOWM_BE_PREVENTED_TIME)
+	if (IsBeingPrevented && CGame::GetInstance()->GetSceneTime() - bePrevented_start > MARIOWM_BE_PREVENTED_TIME)
 		IsBeingPrevented = false;
 
-	vector<LPCOLLISIONEVENT> coEvents;
-	vector<LPCOLLISIONEVENT> coEventsResult;
 	coEvents.clear();
 
 	CalcPotentialCollisions(coObjects, coEvents);
@@ -152,7 +151,7 @@ void CMarioWM::BePrevented()
 {
 	SetState(MARIOWM_STATE_IDLE);
 	IsBeingPrevented = true;
-	bePrevented_start =(DWORD) GetTickCount64();
+	bePrevented_start =(DWORD) CGame::GetInstance()->GetSceneTime();
 }
 
 void CMarioWM::AddCard(int  card)
@@ -51,7 +51,7 @@ private:
 	int IdPlayScene;
 public:
 	bool IsBeingPrevented;
-	int targetScene;
+	int targetScene = -1;		// play scene of the station Mario stands on, -1 for none
 
 	CMarioWM(float x = 0.0f, float y = 0.0f);
 	virtual void Update(DWORD dt, vector<LPGAMEOBJECT>* colliable_objects = NULL);
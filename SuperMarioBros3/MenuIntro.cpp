@@ -21,5 +21,5 @@ void CMenuIntro::Render()
 }
 void CMenuIntro::GetBoundingBox(float& left, float& top, float& right, float& bottom)
 {
-
+	left = top = right = bottom = 0;
 }
\ No newline at end of file
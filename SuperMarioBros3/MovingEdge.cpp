@@ -39,7 +39,7 @@ void CMovingEdge::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 
 void CMovingEdge:: GetBoundingBox(float& l, float& t, float& r, float& b)
 {
-
+	l = t = r = b = 0;
 }
 
 void CMovingEdge::SetState(int state)
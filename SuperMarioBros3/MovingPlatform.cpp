@@ -4,6 +4,7 @@
 
 CMovingPlatform::CMovingPlatform(float _x, float _y): CGameObject()
 {
+	kind = OBJECT_KIND_MOVING_PLATFORM;
 	x = _x;
 	y = _y;
 	SetState(MPLATFORM_STATE_MOVING);
@@ -56,8 +57,6 @@ void CMovingPlatform::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 	}
 
 
-	vector<LPCOLLISIONEVENT> coEvents;
-	vector<LPCOLLISIONEVENT> coEventsResult;
 
 	coEvents.clear();
 	CalcPotentialCollisions(coObjects, coEvents);
@@ -1,4 +1,5 @@
 #include "NameOfGame.h"
+#include "Game.h"
 #include "HUD.h"
 #include "Utils.h"
 
@@ -17,7 +18,7 @@ CNameOfGame::CNameOfGame()
 }
 void CNameOfGame::GetBoundingBox(float& left, float& top, float& right, float& bottom)
 {
-	
+	left = top = right = bottom = 0;
 }
 void CNameOfGame::Update(DWORD dt)
 {
@@ -36,7 +37,7 @@ void CNameOfGame::Update(DWORD dt)
 			{
 				// v?a b? ko xu?ng
 				isShaking = true;
-				shake_start = (DWORD)GetTickCount64();
+				shake_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 				isReadyToShake = false;
 				y = 0;
 			}
@@ -45,7 +46,7 @@ void CNameOfGame::Update(DWORD dt)
 				if (isShaking)
 				{
 					Shake();
-					if (GetTickCount64() - shake_start > NAMEOFGAME_SHAKING_TIME)
+					if (CGame::GetInstance()->GetSceneTime() - shake_start > NAMEOFGAME_SHAKING_TIME)
 					{
 						isShaking = false;
 						y = 0;
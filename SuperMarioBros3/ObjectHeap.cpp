@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "ObjectHeap.h"
+#include "World.h"
+
+static_assert(sizeof(CHeapBlock) <= HEAP_BLOCK_HEADER_SIZE, "CHeapBlock does not fit its header");
+
+CObjectHeap::CObjectHeap()
+{
+	head.prev = head.next = &head;
+	head.heap = this;
+	head.size = 0;
+	head.type = 0;
+	head.dead = false;
+	head.cached = false;
+	head.marked = false;
+}
+
+/*
+	Objects still alive here were never deleted by their scene, their memory goes with the
+	world anyway
+*/
+CObjectHeap::~CObjectHeap()
+{
+	while (head.next != &head)
+	{
+		CHeapBlock* block = head.next;
+		Unlink(block);
+		free(block);
+	}
+}
+
+void* CObjectHeap::Alloc(size_t size, BYTE type)
+{
+	CObjectHeap* heap = &CWorld::GetCurrent()->heap;
+
+	CHeapBlock* block = (CHeapBlock*)malloc(HEAP_BLOCK_HEADER_SIZE + size);
+	if (block == NULL)
+		throw std::bad_alloc();
+	memset(block, 0, HEAP_BLOCK_HEADER_SIZE + size);
+
+	block->heap = heap;
+	block->size = (unsigned int)size;
+	block->type = type;
+
+	block->prev = heap->head.prev;
+	block->next = &heap->head;
+	heap->head.prev->next = block;
+	heap->head.prev = block;
+
+	return block->GetObject();
+}
+
+void CObjectHeap::Free(void* p)
+{
+	if (p == NULL)
+		return;
+
+	CHeapBlock* block = CHeapBlock::Of(p);
+	CObjectHeap* heap = block->heap;
+	if (heap->snapshots > 0)
+	{
+		block->dead = true;
+		return;
+	}
+
+	heap->Unlink(block);
+	free(block);
+}
+
+void CObjectHeap::Unlink(CHeapBlock* block)
+{
+	block->prev->next = block->next;
+	block->next->prev = block->prev;
+}
+
+void CObjectHeap::FreeDeadBlocks()
+{
+	CHeapBlock* block = head.next;
+	while (block != &head)
+	{
+		CHeapBlock* next = block->next;
+		if (block->dead)
+		{
+			Unlink(block);
+			free(block);
+		}
+		block = next;
+	}
+}
+
+void CObjectHeap::RemoveSnapshot()
+{
+	snapshots--;
+	if (snapshots == 0)
+		FreeDeadBlocks();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Windows.h>
+
+#define HEAP_BLOCK_GAME_OBJECT	1
+#define HEAP_BLOCK_UNIT			2
+
+// keeps the objects after the header as aligned as malloc returns them
+#define HEAP_BLOCK_HEADER_SIZE	32
+
+class CObjectHeap;
+
+struct CHeapBlock
+{
+	CHeapBlock* prev;
+	CHeapBlock* next;
+	CObjectHeap* heap;
+	unsigned int size;		// bytes of the object after the header
+	BYTE type;				// HEAP_BLOCK_
+	bool dead;				// deleted while a snapshot was held, kept so the snapshot can bring it back
+	bool cached;			// not game state, snapshots leave it out and restoring leaves it alone
+	bool marked;			// scratch flag of CSnapshot::RestoreObjects
+
+	void* GetObject() { return (BYTE*)this + HEAP_BLOCK_HEADER_SIZE; }
+	static CHeapBlock* Of(void* object) { return (CHeapBlock*)((BYTE*)object - HEAP_BLOCK_HEADER_SIZE); }
+};
+
+/*
+	Memory of the game objects and grid units of one world, every block linked in a list so
+	a snapshot can find them all. While a snapshot is held a deleted object keeps its memory
+	(marked dead) because the snapshot may bring it back at the same address, which keeps
+	every pointer to it valid. The dead blocks are freed once no snapshot needs them.
+*/
+class CObjectHeap
+{
+	friend class CSnapshot;
+
+	CHeapBlock head;		// sentinel of the circular block list
+	int snapshots = 0;		// snapshots holding images of this heap's objects
+
+	void Unlink(CHeapBlock* block);
+	void FreeDeadBlocks();
+
+public:
+	CObjectHeap();
+	~CObjectHeap();
+
+	// zeroed memory for an object of the current world
+	static void* Alloc(size_t size, BYTE type);
+	static void Free(void* p);
+
+	// for objects made on demand by a cache that keeps them whatever the game does
+	static void SetCached(void* p) { CHeapBlock::Of(p)->cached = true; }
+
+	// walk of the blocks in allocation order, dead ones included
+	CHeapBlock* GetFirst() { return head.next; }
+	bool IsEnd(CHeapBlock* block) { return block == &head; }
+
+	void AddSnapshot() { snapshots++; }
+	void RemoveSnapshot();
+};
@@ -2,6 +2,7 @@
 
 CPlant::CPlant(float _x, float _y, float _limit_y, int _type)
 {
+	kind = OBJECT_KIND_PLANT;
 	x = _x;
 	y = _y;
 	start_y = _y;
@@ -3,6 +3,7 @@
 #include "PlayScence.h"
 #include <math.h>
 #include "Utils.h"
+#include "Snapshot.h"
 
 
 CPlant_Fire::CPlant_Fire(float _x, float _y, float _limit_y, int _type): CPlant(_x,_y,_limit_y,_type)
@@ -35,7 +36,7 @@ void CPlant_Fire::Render()
 	//Render Bullet
 	for (int i = 0; (unsigned)i < bullets.size(); i++)
 	{
-		bullets[i]->Render();
+		bullets[i]->RenderInterpolated();
 	}
 	//
 	if (IsInCamera() == false || state == PLANT_FIRE_STATE_SLEEPING)
@@ -196,7 +197,7 @@ void CPlant_Fire::CalculateAngle()
 
 void CPlant_Fire::UpdateInLoop()
 {
-	if (state == PLANT_FIRE_STATE_SLEEPING && GetTickCount64() - sleep_start > PLANT_FIRE_SLEEPING_TIME)
+	if (state == PLANT_FIRE_STATE_SLEEPING && CGame::GetInstance()->GetSceneTime() - sleep_start > PLANT_FIRE_SLEEPING_TIME)
 		SetState(PLANT_FIRE_STATE_MOVING_UP);
 	else if (state == PLANT_FIRE_STATE_MOVING_UP && y <= limit_y)
 	{
@@ -205,12 +206,12 @@ void CPlant_Fire::UpdateInLoop()
 	}
 	else if (state == PLANT_FIRE_STATE_SIGHTING)
 	{
-		if (GetTickCount64() - sight_start > PLANT_FIRE_SIGHTING_TIME)
+		if (CGame::GetInstance()->GetSceneTime() - sight_start > PLANT_FIRE_SIGHTING_TIME)
 			SetState(PLANT_FIRE_STATE_SHOOTING);
 	}
 	else if (state == PLANT_FIRE_STATE_SHOOTING)
 	{
-		if (GetTickCount64() - shoot_start > PLANT_FIRE_SHOOTING_BULLET_TIME)
+		if (CGame::GetInstance()->GetSceneTime() - shoot_start > PLANT_FIRE_SHOOTING_BULLET_TIME)
 			SetState(PLANT_FIRE_STATE_MOVING_DOWN);
 	}
 	else if (state == PLANT_FIRE_STATE_MOVING_DOWN && y >= start_y)
@@ -288,15 +289,15 @@ void CPlant_Fire::SetState(int _state)
 		break;
 	case PLANT_FIRE_STATE_SIGHTING:
 		vy = 0;
-		this->sight_start = (DWORD)GetTickCount64();
+		this->sight_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 		break;
 	case PLANT_FIRE_STATE_SHOOTING:
-		shoot_start = (DWORD)GetTickCount64();
+		shoot_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 		ShootBullet_Plant();
 		break;
 	case PLANT_FIRE_STATE_SLEEPING:
 		vy = 0;
-		this->sleep_start = (DWORD)GetTickCount64();
+		this->sleep_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 		break;
 	}
 }
@@ -310,4 +311,23 @@ void CPlant_Fire::ShootBullet_Plant()
 	CBullet_Plant* bullet = new CBullet_Plant(midx, midy, angle);
 	bullet->nx = this->nx;
 	bullets.push_back(bullet);
-}
\ No newline at end of file
+}
+
+void CPlant_Fire::SaveContainers(CSnapshot& s)
+{
+	CPlant::SaveContainers(s);
+	s.WriteVector(bullets);
+}
+
+void CPlant_Fire::ReleaseContainers()
+{
+	CPlant::ReleaseContainers();
+	vector<CBullet_Plant*>().swap(bullets);
+}
+
+void CPlant_Fire::LoadContainers(CSnapshot& s)
+{
+	CPlant::LoadContainers(s);
+	new (&bullets) vector<CBullet_Plant*>();
+	s.ReadVector(bullets);
+}
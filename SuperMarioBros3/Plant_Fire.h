@@ -76,6 +76,9 @@ public:
 	virtual void Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects);
 	virtual void Render();
 	virtual void SetState(int _state);
+	virtual void SaveContainers(CSnapshot& s);
+	virtual void ReleaseContainers();
+	virtual void LoadContainers(CSnapshot& s);
 	void SetAngle(int _angle) { angle = _angle; }
 	int GetAngle() { return angle; }
 	void SetType(int _type) { type = _type; }
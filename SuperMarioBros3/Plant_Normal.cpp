@@ -39,7 +39,7 @@ void CPlant_Normal::Render()
 
 void CPlant_Normal::UpdateInLoop()
 {
-	if (state == PLANT_NORMAL_STATE_SLEEPING && GetTickCount64() - sleep_start > PLANT_NORMAL_SLEEPING_TIME)
+	if (state == PLANT_NORMAL_STATE_SLEEPING && CGame::GetInstance()->GetSceneTime() - sleep_start > PLANT_NORMAL_SLEEPING_TIME)
 		SetState(PLANT_NORMAL_STATE_MOVING_UP);
 	else if (state == PLANT_NORMAL_STATE_MOVING_UP && y <= limit_y)
 	{
@@ -48,7 +48,7 @@ void CPlant_Normal::UpdateInLoop()
 	}
 	else if (state == PLANT_NORMAL_STATE_ATTACKING)
 	{
-		if (GetTickCount64() - attacking_start > PLANT_NORMAL_ATTACKING_TIME)
+		if (CGame::GetInstance()->GetSceneTime() - attacking_start > PLANT_NORMAL_ATTACKING_TIME)
 			SetState(PLANT_NORMAL_STATE_MOVING_DOWN);
 	}
 	else if (state == PLANT_NORMAL_STATE_MOVING_DOWN && y >= start_y)
@@ -123,11 +123,11 @@ void CPlant_Normal::SetState(int _state)
 		break;
 	case PLANT_NORMAL_STATE_ATTACKING:
 		vy = 0;
-		this->attacking_start = (DWORD)GetTickCount64();
+		this->attacking_start = (DWORD)CGame::GetInstance()->GetSceneTime();
 		break;
 	case PLANT_NORMAL_STATE_SLEEPING:
 		vy = 0;
-		this->sleep_start =(DWORD) GetTickCount64();
+		this->sleep_start =(DWORD) CGame::GetInstance()->GetSceneTime();
 		break;
 	}
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <algorithm>
 
 #include "PlayScence.h"
 #include "Utils.h"
@@ -16,6 +18,10 @@
 #include "RewardBox.h"
 #include "PointsEffect.h"
 #include "BackUp.h"
+#include "World.h"
+#include "Snapshot.h"
+#include "StateHash.h"
+#include "AtlasPacker.h"
 #include "Item.h"
 #include "MovingPlatform.h"
 
@@ -75,7 +81,7 @@ void CPlayScene::_ParseSection_TEXTURES(string line)
 	int G = atoi(tokens[3].c_str());
 	int B = atoi(tokens[4].c_str());
 
-	CTextures::GetInstance()->Add(texID, path.c_str(), D3DCOLOR_XRGB(R, G, B));
+	CTextures::GetInstance()->Add(texID, path.c_str(), COLOR_XRGB(R, G, B));
 }
 void CPlayScene::_ParseSection_MAP(string line)
 {
@@ -96,6 +102,13 @@ void CPlayScene::_ParseSection_MAP(string line)
 	this->map = new Map(idMap, tileWidth, tileHeight, tRTileSet, tCTileSet, tRMap, tCMap, totalTiles);
 	map->LoadMatrix(MatrixPath.c_str());
 	map->CreateTilesFromTileSet();
+
+	// optional collision table of the tile set, bricks then collide through the map tiles
+	if (tokens.size() > 9)
+	{
+		wstring CollisionPath = ToWSTR(tokens[9]);
+		map->LoadCollisionFlags(CollisionPath.c_str());
+	}
 }
 void CPlayScene::_ParseSection_ZONE(string line)
 {
@@ -123,7 +136,7 @@ void CPlayScene::_ParseSection_SPRITES(string line)
 	int b = atoi(tokens[4].c_str());
 	int texID = atoi(tokens[5].c_str());
 
-	LPDIRECT3DTEXTURE9 tex = CTextures::GetInstance()->Get(texID);
+	LPTEXTURE tex = CTextures::GetInstance()->Get(texID);
 	if (tex == NULL)
 	{
 		DebugOut(L"[ERROR] Texture ID %d not found!\n", texID);
@@ -177,7 +190,7 @@ void CPlayScene::_ParseSection_ANIMATION_SETS(string line)
 void CPlayScene::_ParseSection_GRID(string line)
 {
 	ifstream gridFile;
-	gridFile.open(line);
+	OpenDataFile(gridFile, ToWSTR(line).c_str());
 
 	int gridCols = -1;
 	int gridRows = -1;
@@ -210,9 +223,96 @@ void CPlayScene::_ParseSection_GRID(string line)
 
 	gridFile.close();
 
+	_MergeBricks();
+	grid->BuildStaticLayer();
 
 	DebugOut(L"\nParseSection_GRID: Done\n");
 }
+/*
+	Solid bricks lying next to each other in the same grid cell become one bigger collider,
+	so movers test a few rectangles instead of every tile. Big blocks can only be stood on
+	from above, they are merged along rows only. Pipes never get here, they are drawn tile
+	by tile.
+*/
+void CPlayScene::_MergeBricks()
+{
+	sort(brickTiles.begin(), brickTiles.end(), [](const CBrickTile& a, const CBrickTile& b)
+	{
+		if (a.gridRow != b.gridRow)
+			return a.gridRow < b.gridRow;
+		if (a.gridCol != b.gridCol)
+			return a.gridCol < b.gridCol;
+		return a.brick->GetType() < b.brick->GetType();
+	});
+
+	int colliders = 0;
+	size_t first = 0;
+	while (first < brickTiles.size())
+	{
+		// tiles of one type in one cell, keyed by (tile row, tile column)
+		int gridRow = brickTiles[first].gridRow;
+		int gridCol = brickTiles[first].gridCol;
+		int type = brickTiles[first].brick->GetType();
+
+		std::map<pair<int, int>, CBrick*> tiles;
+		size_t last = first;
+		for (; last < brickTiles.size(); last++)
+		{
+			CBrickTile& tile = brickTiles[last];
+			if (tile.gridRow != gridRow || tile.gridCol != gridCol || tile.brick->GetType() != type)
+				break;
+
+			pair<int, int> key((int)(tile.brick->y / BRICK_BBOX_HEIGHT), (int)(tile.brick->x / BRICK_BBOX_WIDTH));
+			if (!tiles.insert(make_pair(key, tile.brick)).second)
+				delete tile.brick;		// the same tile listed twice
+		}
+
+		while (!tiles.empty())
+		{
+			// grow the top-left remaining tile to the right, then downward
+			int row = tiles.begin()->first.first;
+			int col = tiles.begin()->first.second;
+			CBrick* brick = tiles.begin()->second;
+
+			int width = 1;
+			while (tiles.count(make_pair(row, col + width)))
+				width++;
+
+			int height = 1;
+			if (type != BRICK_TYPE_BIG_BLOCK)
+			{
+				bool full = true;
+				while (full)
+				{
+					for (int j = col; j < col + width && full; j++)
+						full = tiles.count(make_pair(row + height, j)) > 0;
+					if (full)
+						height++;
+				}
+			}
+
+			for (int i = row; i < row + height; i++)
+				for (int j = col; j < col + width; j++)
+				{
+					auto it = tiles.find(make_pair(i, j));
+					if (it->second != brick)
+						delete it->second;
+					tiles.erase(it);
+				}
+
+			brick->SetSize((float)width * BRICK_BBOX_WIDTH, (float)height * BRICK_BBOX_HEIGHT);
+			objects.push_back(brick);
+			grid->AddStatic(brick, gridRow, gridCol);
+			colliders++;
+		}
+
+		first = last;
+	}
+
+	DebugOut(L"[INFO] Merged %d bricks into %d colliders\n", (int)brickTiles.size(), colliders);
+	brickTiles.clear();
+}
+
 void CPlayScene::_ParseObjectsFromGrid(string line)
 {
 	vector<string> tokens = split(line);
@@ -331,11 +431,38 @@ void CPlayScene::_ParseObjectsFromGrid(string line)
 		LPANIMATION_SET ani_set = animation_sets->Get(ani_set_id);
 
 		obj->SetAnimationSet(ani_set);
-		objects.push_back(obj);
 
 		int gridCol = (int)atoi(tokens[tokens.size() - 1].c_str());
 		int gridRow = (int)atoi(tokens[tokens.size() - 2].c_str());
-		CUnit* unit = new CUnit(gridRow, gridCol, grid, obj);
+
+		// the map tile layer collides for the bricks, pipes are only kept to be drawn
+		if (object_type == OBJECT_TYPE_BRICK && map != NULL && map->HasCollision())
+		{
+			if (((CBrick*)obj)->GetType() != BRICK_TYPE_PIPE)
+			{
+				delete obj;
+				return;
+			}
+			objects.push_back(obj);
+			grid->AddStatic(obj, gridRow, gridCol, false);
+			return;
+		}
+
+		// solid bricks on the tile grid are merged with their neighbours once the file is read
+		if (object_type == OBJECT_TYPE_BRICK && ((CBrick*)obj)->GetType() != BRICK_TYPE_PIPE
+			&& fmod(x, BRICK_BBOX_WIDTH) == 0 && fmod(y, BRICK_BBOX_HEIGHT) == 0)
+		{
+			brickTiles.push_back({ (CBrick*)obj, gridRow, gridCol });
+			return;
+		}
+
+		objects.push_back(obj);
+
+		// bricks and portals never move, they go to the static layer of the grid
+		if (object_type == OBJECT_TYPE_BRICK || object_type == OBJECT_TYPE_PORTAL)
+			grid->AddStatic(obj, gridRow, gridCol);
+		else
+			new CUnit(gridRow, gridCol, grid, obj);		// the unit links itself into its cell of the grid
 	}
 }
 void CPlayScene::_ParseSection_OBJECTS(string line)
@@ -448,7 +575,7 @@ void CPlayScene::Load()
 	DebugOut(L"[INFO] Start loading scene resources from : %s \n", sceneFilePath);
 
 	ifstream f;
-	f.open(sceneFilePath);
+	OpenDataFile(f, sceneFilePath);
 
 	// current resource section flag
 	int section = SCENE_SECTION_UNKNOWN;					
@@ -488,7 +615,17 @@ void CPlayScene::Load()
 
 	f.close();
 
-	CTextures::GetInstance()->Add(ID_TEX_BBOX, L"textures\\bbox.png", D3DCOLOR_XRGB(255, 255, 255));
+	CTextures::GetInstance()->Add(ID_TEX_BBOX, L"textures\\bbox.png", COLOR_XRGB(255, 255, 255));
+
+	// the sprites and tiles of the scene drawn from an atlas or two instead of one texture per sheet
+	if (CGame::GetInstance()->GetPackAtlases())
+	{
+		CAtlasPacker packer;
+		packer.AddAll(CSprites::GetInstance());
+		if (map)
+			packer.AddAll(map->GetTiles());
+		packer.Pack();
+	}
 
 	CBackUp::GetInstance()->LoadBackUpMario(player);
 
@@ -496,33 +633,41 @@ void CPlayScene::Load()
 
 	hud = new CHUD(HUD_TYPE_PLAYSCENE);
 	SetCamera();
+	loads++;
 }
 
 void CPlayScene::Update(DWORD dt)
 {
-	// We know that Mario is the first object in the list hence we won't add him into the colliable object list
-	// TO-DO: This is a "dirty" way, need a more organized way 
+	// static colliders in view first, then every moving object in view
 	GetListUnitFromGrid();
-	vector<LPGAMEOBJECT> coObjects;
+	coObjects.assign(listStatics.begin(), listStatics.end());
 	for (size_t i = 0; i < listUnits.size(); i++)
-		coObjects.push_back(listUnits.at(i)->GetObj());
+	{
+		LPGAMEOBJECT object = listUnits[i]->GetObj();
+		object->RefreshBoundingBox();
+		coObjects.push_back(object);
+	}
 
+	// only the dynamic layer is updated, static colliders never move
 	for (size_t i = 0; i < listUnits.size(); i++)
 	{
 		LPGAMEOBJECT object = listUnits[i]->GetObj();
-		if (!dynamic_cast<CBrick*>(object))
-		{
-			object->Update(dt, &coObjects);
+		object->Update(dt, &coObjects);
+		object->RefreshBoundingBox();
 
-				float newx, newy;
-			listUnits[i]->GetObj()->GetPosition(newx, newy);
-			listUnits[i]->Move(newx, newy);
-		}
+		float newx, newy;
+		object->GetPosition(newx, newy);
+		listUnits[i]->Move(newx, newy);
 	}
+	updatedObjects = listUnits.size();
 
 	for (size_t i = 0; i < listEnemies.size(); i++)
 		if (listEnemies[i]->IsInCamera() == false)
+		{
 			listEnemies[i]->Update(dt, &coObjects);
+			listEnemies[i]->RefreshBoundingBox();
+			updatedObjects++;
+		}
 
 	// skip the rest if scene was already unloaded (Mario::Update might trigger PlayScene::Unload)
 	if (player == NULL) return;
@@ -543,11 +688,52 @@ void CPlayScene::Update(DWORD dt)
 	//update pointsEffects
 	CPointsEffects::GetInstance()->Update(dt);
 
+	if (CGame::GetInstance()->GetHashStates())
+		stateHash = HashState();
+
 	//out to WorldMap when mario die
 	if ( player->y > CZones::GetInstance()->Get(idZone)->GetBottom())
 		CGame::GetInstance()->SwitchScene(idWorldMap);
 }
 
+static ULONGLONG HashObject(LPGAMEOBJECT o)
+{
+	CStateHash h;
+	h.Add(o->kind, o->state);
+	h.Add(o->x, o->y);
+	h.Add(o->vx, o->vy);
+	h.Add(o->nx, (int)o->IsEnable);
+	return CStateHash::Mix(h.Get());
+}
+
+/*
+	Hash of what a step leaves behind: position, speed, direction and state of Mario and of
+	every object the step updated, Mario's level and counters, the clock and the camera. The
+	objects are summed in so the hash does not depend on the order the grid lists them in.
+	Only runs when the game hashes states, see CGame::SetHashStates
+*/
+ULONGLONG CPlayScene::HashState()
+{
+	ULONGLONG objectsSum = HashObject(player);
+	for (size_t i = 0; i < listUnits.size(); i++)
+		objectsSum += HashObject(listUnits[i]->GetObj());
+	for (size_t i = 0; i < listEnemies.size(); i++)
+		if (listEnemies[i]->IsInCamera() == false)
+			objectsSum += HashObject(listEnemies[i]);
+
+	CStateHash h;
+	h.Add(objectsSum);
+	h.Add(player->GetLevel(), player->GetPoints());
+	h.Add(player->GetMoney(), player->GetLife());
+	h.Add((unsigned int)remainTime, idZone);
+	h.Add(GetClock());
+
+	float cx, cy;
+	CGame::GetInstance()->GetCamPos(cx, cy);
+	h.Add(cx, cy);
+	return h.Get();
+}
+
 void CPlayScene::SetCamera()
 {
 	float cx, cy;
@@ -587,15 +773,27 @@ void CPlayScene::SetCamera()
 
 void CPlayScene::Render()
 {
+	CGame* game = CGame::GetInstance();
+
+	game->SetDrawLayer(RENDER_LAYER_MAP);
 	if (map)
 		this->map->Render();
 
+	game->SetDrawLayer(RENDER_LAYER_OBJECTS);
 	for (int i = listUnits.size()-1; i >= 0; i--)
 	{
-		listUnits[i]->GetObj()->Render();
+		listUnits[i]->GetObj()->RenderInterpolated();
 	}
 
+	// static layer goes on top so pipes still cover the plants
+	game->SetDrawLayer(RENDER_LAYER_STATICS);
+	for (size_t i = 0; i < listStatics.size(); i++)
+		listStatics[i]->Render();
+
+	game->SetDrawLayer(RENDER_LAYER_HUD);
 	hud->Render();
+
+	game->SetDrawLayer(RENDER_LAYER_EFFECTS);
 	CPointsEffects::GetInstance()->Render();
 	if (noti)
 		noti->Render();
@@ -613,6 +811,13 @@ void CPlayScene::Unload()
 	
 	objects.clear();
 	player = NULL;
+	edge = nullptr;
+
+	// the lists point into the objects just deleted, a later Load must not find them
+	listUnits.clear();
+	listStatics.clear();
+	listEnemies.clear();
+	coObjects.clear();
 
 	delete map;
 	map = nullptr;
@@ -628,6 +833,78 @@ void CPlayScene::Unload()
 
 	DebugOut(L"[INFO] Scene %s unloaded! \n", sceneFilePath);
 }
+/*
+	Save everything a step can change: the objects and grid units (their bytes, see
+	CSnapshot), the grid's cell lists, the clock and timers, the HUD, the camera and the
+	registries the objects reach through GetInstance. Map, zones and the static layer are
+	left out, they do not change once the scene is loaded.
+*/
+void CPlayScene::SaveSnapshot(CSnapshot& s)
+{
+	s.SaveObjects(&CWorld::GetCurrent()->heap);
+	s.SetScene(this, loads);
+
+	s.Write(clock);
+	timers.Save(s);
+	s.Write(updatedObjects);
+
+	s.Write(remainTime);
+	s.Write(stateHash);
+	s.Write(idZone);
+	s.Write(noti);
+	s.WriteVector(listUnits);
+	s.WriteVector(listStatics);
+	grid->Save(s);
+	s.Write(*hud);
+
+	float cx, cy, pcx, pcy;
+	CGame* game = CGame::GetInstance();
+	game->GetCamPos(cx, cy);
+	game->GetPrevCamPos(pcx, pcy);
+	s.Write(cx); s.Write(cy);
+	s.Write(pcx); s.Write(pcy);
+
+	CPointsEffects::GetInstance()->Save(s);
+	CAnimations::GetInstance()->Save(s);
+	s.Write(*CBackUp::GetInstance());
+}
+
+/*
+	Go back to the snapshot, false when it was not taken in this load of the scene
+*/
+bool CPlayScene::RestoreSnapshot(CSnapshot& s)
+{
+	if (s.IsEmpty() || !s.IsOf(this, loads) || player == NULL)
+		return false;
+
+	s.RestoreObjects();
+
+	s.Read(clock);
+	timers.Load(s);
+	s.Read(updatedObjects);
+
+	s.Read(remainTime);
+	s.Read(stateHash);
+	s.Read(idZone);
+	s.Read(noti);
+	s.ReadVector(listUnits);
+	s.ReadVector(listStatics);
+	grid->Load(s);
+	s.Read(*hud);
+
+	float cx, cy, pcx, pcy;
+	s.Read(cx); s.Read(cy);
+	s.Read(pcx); s.Read(pcy);
+	CGame* game = CGame::GetInstance();
+	game->SetCamPos(cx, cy);
+	game->SetPrevCamPos(pcx, pcy);
+
+	CPointsEffects::GetInstance()->Load(s);
+	CAnimations::GetInstance()->Load(s);
+	s.Read(*CBackUp::GetInstance());
+	return true;
+}
+
 void CPlayScene::TransferZone(CPortal* portal)
 {
 	int tartgetZone = portal->GetTartgetZone();
@@ -640,9 +917,11 @@ void CPlayScene::TransferZone(CPortal* portal)
 void CPlayScene::GetListUnitFromGrid()
 {
 	listUnits.clear();
+	listStatics.clear();
 	float cx = 0, cy = 0;
 	CGame::GetInstance()->GetCamPos(cx, cy);
 	grid->Get(cx, cy, listUnits);
+	grid->GetStatic(cx, cy, listStatics);
 }
 
 void CPlayScenceKeyHandler::OnKeyDown(int KeyCode)
@@ -18,6 +18,14 @@
 
 #define COUNT_DOWN_TIME_DEFAULT			300000
 
+// a solid brick read from the grid file, waiting to be merged with its neighbours
+struct CBrickTile
+{
+	CBrick* brick;
+	int gridRow;
+	int gridCol;
+};
+
 class CPlayScene : public CScene
 {
 protected:
@@ -25,6 +33,8 @@ protected:
 
 	vector<LPGAMEOBJECT> objects;
 	vector<CUnit*> listUnits;
+	vector<LPGAMEOBJECT> listStatics;
+	vector<LPGAMEOBJECT> coObjects;		// rebuilt every frame, kept to reuse its storage
 	vector<CEnemy*> listEnemies;
 	Map* map;
 	CHUD* hud;
@@ -35,6 +45,9 @@ protected:
 
 	CGrid* grid = nullptr;
 	CMovingEdge* edge = nullptr;
+	vector<CBrickTile> brickTiles;
+	int loads = 0;					// times Load ran, a snapshot only restores into the load it was taken in
+	ULONGLONG stateHash = 0;		// HashState at the end of the last Update
 
 
 	void _ParseSection_TEXTURES(string line);
@@ -45,10 +58,12 @@ protected:
 	void _ParseSection_MAP(string line);
 	void _ParseSection_ZONE(string line);
 	void _ParseSection_GRID(string line);
+	void _MergeBricks();
 	void _ParseSection_OBJECTS(string line);
 
 	void SetCamera();
 	void GetListUnitFromGrid();
+	ULONGLONG HashState();
 public:
 
 	CPlayScene(int id, LPCWSTR filePath, int _idWorldMap);
@@ -64,8 +79,15 @@ public:
 	DWORD GetRemainTime() { return remainTime; }
 	vector<LPGAMEOBJECT> GetObjects() { return objects; }
 	void SetNoti(CEndSceneNotification* n) { noti = n; }
+	CEndSceneNotification* GetNoti() { return noti; }
 	void TransferZone(CPortal* portal);
 	CGrid* GetGrid() { return grid; }
+
+	void SaveSnapshot(CSnapshot& s);
+	bool RestoreSnapshot(CSnapshot& s);
+
+	// two runs of the same input agree on it every frame until their behavior diverges
+	ULONGLONG GetStateHash() { return stateHash; }
 	
 
 	void Tele(float x, float y);
@@ -1,5 +1,7 @@
 #include "PointsEffect.h"
 #include "HUD.h"
+#include "World.h"
+#include "Snapshot.h"
 
 CPointsEffect::CPointsEffect(float _x, float _y, unsigned int point)
 {
@@ -65,8 +67,6 @@ void CPointsEffect::Render()
 }
 
 
-CPointsEffects* CPointsEffects::__instance = nullptr;
-
 void CPointsEffects::Update(DWORD dt)
 {
 	for (unsigned int i = 0; i < pointsEffects.size(); i++)
@@ -95,9 +95,7 @@ void CPointsEffects::Add(CPointsEffect* pointsEffect)
 }
 CPointsEffects* CPointsEffects::GetInstance()
 {
-	if (__instance == nullptr)
-		__instance = new CPointsEffects();
-	return __instance;
+	return &CWorld::GetCurrent()->pointsEffects;
 }
 void CPointsEffects::Clear()
 {
@@ -108,4 +106,14 @@ void CPointsEffects::Clear()
 		pe = nullptr;
 	}
 	pointsEffects.clear();
-}
\ No newline at end of file
+}
+
+void CPointsEffects::Save(CSnapshot& s)
+{
+	s.WriteVector(pointsEffects);
+}
+
+void CPointsEffects::Load(CSnapshot& s)
+{
+	s.ReadVector(pointsEffects);
+}
@@ -45,7 +45,6 @@ public:
 
 class CPointsEffects
 {
-	static CPointsEffects* __instance;
 	vector<CPointsEffect*> pointsEffects;
 
 public:
@@ -54,5 +53,8 @@ public:
 	void Render();
 	void Clear();
 
+	void Save(CSnapshot& s);
+	void Load(CSnapshot& s);
+
 	static CPointsEffects* GetInstance();
 };
\ No newline at end of file
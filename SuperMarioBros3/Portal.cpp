@@ -3,6 +3,7 @@
 
 CPortal::CPortal(float l, float t, float r, float b, int _targetZone, float _targetX, float _targetY, int _type)
 {
+	kind = OBJECT_KIND_PORTAL;
 	this->targetZone = _targetZone;
 	this->targetX = _targetX;
 	this->targetY = _targetY;
@@ -0,0 +1,71 @@
+#pragma once
+#include <Windows.h>
+#include <vector>
+
+using namespace std;
+
+typedef DWORD COLOR;	// 0xAARRGGBB, same layout as D3DCOLOR
+
+#define COLOR_ARGB(a,r,g,b) \
+	((COLOR)((((a)&0xff)<<24)|(((r)&0xff)<<16)|(((g)&0xff)<<8)|((b)&0xff)))
+#define COLOR_XRGB(r,g,b)	COLOR_ARGB(0xff,r,g,b)
+
+// parts of a frame in the order they are drawn, see CRenderer::SetLayer
+#define RENDER_LAYER_MAP		0
+#define RENDER_LAYER_OBJECTS	1
+#define RENDER_LAYER_STATICS	2
+#define RENDER_LAYER_HUD		3
+#define RENDER_LAYER_EFFECTS	4
+
+/*
+	Texture loaded by a renderer, each backend keeps its own data behind it
+*/
+class CTexture
+{
+public:
+	int width = 0;
+	int height = 0;
+
+	virtual ~CTexture() {}
+};
+typedef CTexture * LPTEXTURE;
+
+// part (left, top, right, bottom) of a texture copied to x, y of an atlas
+struct CAtlasCopy
+{
+	LPTEXTURE source;
+	int left, top, right, bottom;
+	int x, y;
+};
+
+/*
+	What the game needs to put sprites on the screen. CD3D9Renderer draws with Direct3D 9
+	on Windows, CNullRenderer (Headless) only counts the calls and builds anywhere
+*/
+class CRenderer
+{
+public:
+	virtual bool Init(HWND hWnd, int width, int height) = 0;
+
+	// NULL when the file cannot be loaded. Pixels of transparentColor are drawn transparent
+	virtual LPTEXTURE LoadTexture(LPCWSTR filePath, COLOR transparentColor) = 0;
+
+	// texture of width x height made of parts of loaded textures, the rest transparent.
+	// NULL when the backend cannot make one, see CAtlasPacker
+	virtual LPTEXTURE CreateAtlas(int width, int height, const vector<CAtlasCopy>& copies) { return NULL; }
+	// clears left, top, right, bottom of an atlas made by CreateAtlas and copies the parts
+	// into it (x, y of the atlas), false when it cannot
+	virtual bool UpdateAtlas(LPTEXTURE atlas, int left, int top, int right, int bottom, const vector<CAtlasCopy>& copies) { return false; }
+
+	virtual void BeginFrame(COLOR background) = 0;
+	// part (left, top, right, bottom) of texture at screen position x, y
+	virtual void Draw(LPTEXTURE texture, float x, float y, int left, int top, int right, int bottom, int alpha) = 0;
+	virtual void EndFrame() = 0;
+
+	// layer of the draws that follow, a frame starts at 0. A renderer that reorders draws
+	// keeps every draw of a layer under those of the layers above
+	virtual void SetLayer(int layer) {}
+
+	virtual ~CRenderer() {}
+};
+typedef CRenderer * LPRENDERER;
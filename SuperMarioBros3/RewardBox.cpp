@@ -11,6 +11,8 @@
 
 CRewardBox::CRewardBox(float _x, float _y, int _type, int _rewardType)
 {
+	kind = OBJECT_KIND_REWARD_BOX;
+	hideTimer = TIMER_NONE;
 	this->type = _type;
 	this->rewardType = _rewardType;
 	this->start_y = _y;
@@ -65,23 +67,24 @@ void CRewardBox::Render()
 			{
 				if (!isHiding)
 					animation_set->at(ani)->Render(x, y);
-				reward->Render();
+				reward->RenderInterpolated();
 				return;
 			}
 			else
-				reward->Render();
+				reward->RenderInterpolated();
 		}
 		else
-			reward->Render();
+			reward->RenderInterpolated();
 	}
 
 	if (!isHiding)
 		animation_set->at(ani)->Render(x, y);
 }
 
-void CRewardBox::UpdateFlag()
+void CRewardBox::EndHiding()
 {
-	if (isHiding && GetTickCount64() - hide_start > REWARD_HIDING_TIME && reward->IsEnable)
+	// a reward taken meanwhile keeps the box hidden
+	if (isHiding && reward->IsEnable)
 		isHiding = false;
 }
 void CRewardBox::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
@@ -105,7 +108,6 @@ void CRewardBox::Update(DWORD dt, vector<LPGAMEOBJECT>* coObjects)
 		}
 
 	}
-	UpdateFlag();
 	CalculateBeSwingedTail();
 	if (type == REWARD_BOX_TYPE_GOLD)
 		Update_GoldBox(coObjects);
@@ -288,5 +290,6 @@ void CRewardBox::SetState(int _state)
 void CRewardBox::Hide()
 {
 	isHiding = true;
-	hide_start = (DWORD)GetTickCount64();
+	hide_start = (DWORD)CGame::GetInstance()->GetSceneTime();
+	StartTimer(hideTimer, REWARD_HIDING_TIME, (LPTIMERCALLBACK)&CRewardBox::EndHiding);
 }
\ No newline at end of file
@@ -34,8 +34,9 @@ private:
 	int type;
 	int rewardType;
 	float start_y;
-	CGameObject* reward;
+	CGameObject* reward = nullptr;
 	DWORD hide_start;
+	int hideTimer;			// shows the box again, on the scene's timer wheel
 	int coinStack = REWARD_BOX_MAX_COIN_STACK;
 
 	void CalculateBeSwingedTail();
@@ -56,7 +57,7 @@ public:
 	void BeBroken();
 	void Hide();
 	void CreateReward();
-	void UpdateFlag();
+	void EndHiding();
 
 	int GetType() { return this->type; }
 	void SetState(int _state);
@@ -54,7 +54,7 @@ public:
 	void Update_MushRoom(DWORD dt, vector<LPGAMEOBJECT>* coObjects);
 
 	bool IsOnTheLeftOfMario();
-	void CalcPotentialCollisions(vector<LPGAMEOBJECT>* coObjects, vector<LPCOLLISIONEVENT>& coEvents);
+	void CalcPotentialCollisions(vector<LPGAMEOBJECT>* coObjects, vector<CCollisionEvent>& coEvents);
 
 	int GetType() { return type; }
 	void SetType(int _type) { type = _type; }
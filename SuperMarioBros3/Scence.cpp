@@ -4,4 +4,10 @@ CScene::CScene(int id, LPCWSTR filePath)
 {
 	this->id = id;
 	this->sceneFilePath = filePath;
+	timers.Reset(clock);
+}
+
+CScene::~CScene()
+{
+	delete key_handler;
 }
\ No newline at end of file
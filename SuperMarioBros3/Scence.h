@@ -1,11 +1,14 @@
 #pragma once
 
-#include <d3dx9.h>
 #include "KeyEventHandler.h"
+#include "TimerWheel.h"
 
 #define WORLDMAP_1_ID	1
 #define SCENE_1_1_ID	101
 
+// timers left at 0 must read as long expired, as they did with GetTickCount64
+#define SCENE_CLOCK_START	100000
+
 class CScene
 {
 protected:
@@ -13,12 +16,20 @@ protected:
 	int id;
 	LPCWSTR sceneFilePath;
 
+	ULONGLONG clock = SCENE_CLOCK_START;	// simulation time in ms, only moved by AdvanceClock
+	CTimerWheel timers;						// timers of the scene's objects, fired by AdvanceClock
+	int updatedObjects = 0;					// objects the last Update ran
 
 public: 
 
 	CScene(int id, LPCWSTR filePath);
+	virtual ~CScene();
 
 	CKeyEventHandler * GetKeyEventHandler() { return key_handler; }
+	void AdvanceClock(DWORD dt) { clock += dt; timers.Advance(clock); }
+	ULONGLONG GetClock() { return clock; }
+	CTimerWheel* GetTimers() { return &timers; }
+	int GetUpdatedObjects() { return updatedObjects; }
 	virtual void Load() = 0;
 	virtual void Unload() = 0;
 	virtual void Update(DWORD dt) = 0;
@@ -0,0 +1,106 @@
+#include "Snapshot.h"
+#include "GameObject.h"
+#include "Grid.h"
+
+CSnapshot::~CSnapshot()
+{
+	Clear();
+}
+
+/*
+	Drop the contents, the storage is kept for the next save
+*/
+void CSnapshot::Clear()
+{
+	if (heap != NULL)
+		heap->RemoveSnapshot();
+	heap = NULL;
+	objects.clear();
+	data.clear();
+	readPos = 0;
+	scene = NULL;
+}
+
+void CSnapshot::SaveObjects(CObjectHeap* heap)
+{
+	Clear();
+	this->heap = heap;
+	heap->AddSnapshot();
+
+	// one allocation for the bytes of the objects, the vectors and the scene add a little
+	size_t bytes = 0, count = 0;
+	for (CHeapBlock* block = heap->head.next; block != &heap->head; block = block->next)
+	{
+		bytes += block->size;
+		count++;
+	}
+	objects.reserve(count);
+	data.reserve(bytes + bytes / 4);
+
+	for (CHeapBlock* block = heap->head.next; block != &heap->head; block = block->next)
+	{
+		if (block->dead || block->cached) continue;
+
+		CSnapshotObject o;
+		o.object = block->GetObject();
+		o.size = block->size;
+		o.type = block->type;
+		objects.push_back(o);
+
+		Write(o.object, o.size);
+		if (o.type == HEAP_BLOCK_GAME_OBJECT)
+			((LPGAMEOBJECT)o.object)->SaveContainers(*this);
+	}
+}
+
+/*
+	Bring the heap back to the snapshot: the objects made since are deleted, the ones it
+	holds get their bytes back (coming back to life if they were deleted since), then the
+	objects rebuild their vectors from what SaveContainers wrote. The reading continues
+	where the objects end, with what the scene saved after them.
+*/
+void CSnapshot::RestoreObjects()
+{
+	for (CHeapBlock* block = heap->head.next; block != &heap->head; block = block->next)
+		block->marked = false;
+	for (size_t i = 0; i < objects.size(); i++)
+		CHeapBlock::Of(objects[i].object)->marked = true;
+
+	newer.clear();
+	for (CHeapBlock* block = heap->head.next; block != &heap->head; block = block->next)
+		if (!block->dead && !block->cached && !block->marked)
+			newer.push_back(block->GetObject());
+
+	// an object deleted by the destructor of another one on the list is dead by now
+	for (size_t i = 0; i < newer.size(); i++)
+	{
+		CHeapBlock* block = CHeapBlock::Of(newer[i]);
+		if (block->dead) continue;
+		if (block->type == HEAP_BLOCK_GAME_OBJECT)
+			delete (LPGAMEOBJECT)newer[i];
+		else
+			delete (CUnit*)newer[i];
+	}
+
+	Rewind();
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		CSnapshotObject& o = objects[i];
+		CHeapBlock* block = CHeapBlock::Of(o.object);
+		bool gameObject = o.type == HEAP_BLOCK_GAME_OBJECT;
+
+		// a dead object's vectors went with its destructor
+		if (gameObject && !block->dead)
+			((LPGAMEOBJECT)o.object)->ReleaseContainers();
+
+		Read(o.object, o.size);
+		block->dead = false;
+
+		if (gameObject)
+			((LPGAMEOBJECT)o.object)->LoadContainers(*this);
+	}
+
+	// nothing else can bring back the rest of the dead objects
+	if (heap->snapshots == 1)
+		heap->FreeDeadBlocks();
+}
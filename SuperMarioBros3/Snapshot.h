@@ -0,0 +1,84 @@
+#pragma once
+#include <string.h>
+#include <new>
+#include <vector>
+#include "ObjectHeap.h"
+
+using namespace std;
+
+class CScene;
+
+struct CSnapshotObject
+{
+	void* object;
+	unsigned int size;
+	BYTE type;			// HEAP_BLOCK_
+};
+
+/*
+	Flat copy of the dynamic state of a play scene (see CPlayScene::SaveSnapshot): the bytes
+	of every live object of the world's heap, plus what the objects and the scene keep in
+	vectors and registries. Restoring copies the bytes back to the same addresses, so the
+	pointers between objects, grid units and containers need no fixing up.
+
+	A snapshot keeps the objects deleted after it was taken from being freed, delete it (or
+	Clear it) to let them go, and before the world it was taken in.
+*/
+class CSnapshot
+{
+	CObjectHeap* heap = NULL;
+	vector<CSnapshotObject> objects;
+	vector<BYTE> data;
+	size_t readPos = 0;
+
+	CScene* scene = NULL;
+	int sceneLoad = 0;			// load of the scene the snapshot was taken in, see CPlayScene
+
+	vector<void*> newer;		// scratch of RestoreObjects
+
+public:
+	~CSnapshot();
+
+	void Clear();
+	bool IsEmpty() { return heap == NULL; }
+
+	void SetScene(CScene* scene, int load) { this->scene = scene; sceneLoad = load; }
+	bool IsOf(CScene* scene, int load) { return this->scene == scene && sceneLoad == load; }
+
+	void SaveObjects(CObjectHeap* heap);
+	void RestoreObjects();
+
+	void Rewind() { readPos = 0; }
+	size_t GetSize() { return data.size() + objects.size() * sizeof(CSnapshotObject); }
+
+	void Write(const void* p, size_t size)
+	{
+		size_t at = data.size();
+		data.resize(at + size);
+		memcpy(&data[at], p, size);
+	}
+	void Read(void* p, size_t size)
+	{
+		memcpy(p, &data[readPos], size);
+		readPos += size;
+	}
+
+	template <class T> void Write(const T& v) { Write(&v, sizeof(T)); }
+	template <class T> void Read(T& v) { Read(&v, sizeof(T)); }
+
+	// vectors of plain values or pointers
+	template <class T> void WriteVector(const vector<T>& v)
+	{
+		size_t n = v.size();
+		Write(n);
+		if (n > 0) Write(&v[0], n * sizeof(T));
+	}
+	template <class T> void ReadVector(vector<T>& v)
+	{
+		size_t n;
+		Read(n);
+		v.resize(n);
+		if (n > 0) Read(&v[0], n * sizeof(T));
+	}
+};
+typedef CSnapshot * LPSNAPSHOT;
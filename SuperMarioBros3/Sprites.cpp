@@ -1,8 +1,9 @@
 #include "Sprites.h"
 #include "Game.h"
 #include "Utils.h"
+#include "World.h"
 
-CSprite::CSprite(int id, int left, int top, int right, int bottom, LPDIRECT3DTEXTURE9 tex)
+CSprite::CSprite(int id, int left, int top, int right, int bottom, LPTEXTURE tex)
 {
 	this->id = id;
 	this->left = left;
@@ -12,12 +13,9 @@ CSprite::CSprite(int id, int left, int top, int right, int bottom, LPDIRECT3DTEX
 	this->texture = tex;
 }
 
-CSprites * CSprites::__instance = NULL;
-
 CSprites *CSprites::GetInstance()
 {
-	if (__instance == NULL) __instance = new CSprites();
-	return __instance;
+	return &CWorld::GetCurrent()->sprites;
 }
 
 void CSprite::Draw(float x, float y, int alpha)
@@ -26,7 +24,7 @@ void CSprite::Draw(float x, float y, int alpha)
 	game->Draw(x, y, texture, left, top, right, bottom, alpha);
 }
 
-void CSprites::Add(int id, int left, int top, int right, int bottom, LPDIRECT3DTEXTURE9 tex)
+void CSprites::Add(int id, int left, int top, int right, int bottom, LPTEXTURE tex)
 {
 	LPSPRITE s = new CSprite(id, left, top, right, bottom, tex);
 	sprites[id] = s;
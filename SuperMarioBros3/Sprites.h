@@ -1,6 +1,6 @@
 #pragma once
 #include <Windows.h>
-#include <d3dx9.h>
+#include "Renderer.h"
 #include <unordered_map>
 
 using namespace std;
@@ -14,9 +14,14 @@ class CSprite
 	int right;
 	int bottom;
 
-	LPDIRECT3DTEXTURE9 texture;
+	LPTEXTURE texture;
 public: 
-	CSprite(int id, int left, int top, int right, int bottom, LPDIRECT3DTEXTURE9 tex);
+	CSprite(int id, int left, int top, int right, int bottom, LPTEXTURE tex);
+
+	LPTEXTURE GetTexture() { return texture; }
+	void GetRect(int& left, int& top, int& right, int& bottom) { left = this->left, top = this->top, right = this->right, bottom = this->bottom; }
+	// the same image found somewhere else, in an atlas
+	void SetImage(LPTEXTURE tex, int left, int top) { right += left - this->left, bottom += top - this->top; this->left = left, this->top = top, texture = tex; }
 
 	void Draw(float x, float y, int alpha = 255);
 	virtual ~CSprite();
@@ -29,14 +34,15 @@ typedef CSprite * LPSPRITE;
 */
 class CSprites
 {
-	static CSprites * __instance;
 
 	unordered_map<int, LPSPRITE> sprites;
 
 public:
-	void Add(int id, int left, int top, int right, int bottom, LPDIRECT3DTEXTURE9 tex);
+	void Add(int id, int left, int top, int right, int bottom, LPTEXTURE tex);
 	LPSPRITE Get(int id);
-	void CSprites::Clear();
+	void Clear();
+
+	template <class F> void ForEach(F f) { for (auto& x : sprites) if (x.second != NULL) f(x.second); }
 
 	static CSprites * GetInstance();
 };
@@ -0,0 +1,64 @@
+#pragma once
+#include <string.h>
+#include <Windows.h>
+
+#define STATE_HASH_BASIS	14695981039346656037ULL
+#define STATE_HASH_PRIME	1099511628211ULL
+
+/*
+	FNV-1a over 64 bit words instead of bytes, one round per word. Values are hashed by
+	their bits, so the smallest change of a position shows, as it should when comparing
+	two builds. Add(a, b) packs two values of 32 bits or less into one word
+*/
+class CStateHash
+{
+	ULONGLONG h = STATE_HASH_BASIS;
+
+	void AddWord(ULONGLONG word) { h = (h ^ word) * STATE_HASH_PRIME; }
+
+public:
+	template <class T> void Add(const T& v)
+	{
+		static_assert(sizeof(T) <= sizeof(ULONGLONG), "more than a word");
+		ULONGLONG word = 0;
+		memcpy(&word, &v, sizeof(T));
+		AddWord(word);
+	}
+
+	template <class A, class B> void Add(const A& a, const B& b)
+	{
+		static_assert(sizeof(A) <= 4 && sizeof(B) <= 4, "more than half a word");
+		DWORD low = 0, high = 0;
+		memcpy(&low, &a, sizeof(A));
+		memcpy(&high, &b, sizeof(B));
+		AddWord((ULONGLONG)high << 32 | low);
+	}
+
+	// a buffer, a word at a time and what is left of it in one more
+	void AddBytes(const void* p, size_t size)
+	{
+		const BYTE* b = (const BYTE*)p;
+		for (; size >= sizeof(ULONGLONG); b += sizeof(ULONGLONG), size -= sizeof(ULONGLONG))
+		{
+			ULONGLONG word;
+			memcpy(&word, b, sizeof(word));
+			AddWord(word);
+		}
+		if (size > 0)
+		{
+			ULONGLONG word = 0;
+			memcpy(&word, b, size);
+			AddWord(word);
+		}
+	}
+
+	ULONGLONG Get() { return h; }
+
+	// scatters a hash so that sums of them do not cancel out, see CPlayScene::HashState
+	static ULONGLONG Mix(ULONGLONG x)
+	{
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+};
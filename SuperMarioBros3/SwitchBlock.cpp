@@ -4,6 +4,7 @@
 #include "RewardBox.h"
 CSwitchBlock::CSwitchBlock(float _x, float _y)
 {
+	kind = OBJECT_KIND_SWITCH_BLOCK;
 	x = _x;
 	y = _y;
 	SetAnimationSet(CAnimationSets::GetInstance()->Get(SWITCH_BLOCK_ANI_SET_ID));
@@ -32,14 +33,15 @@ void CSwitchBlock::GetBoundingBox(float& l, float& t, float& r, float& b)
 void CSwitchBlock::CalcPotentialCollisionWithMario(vector<LPGAMEOBJECT>* coObjects)
 {
 	CMario* mario = ((CPlayScene*)CGame::GetInstance()->GetCurrentScene())->GetPlayer();
-	LPCOLLISIONEVENT e = SweptAABBEx(mario);
+	CCollisionEvent event = SweptAABBEx(mario);
+	LPCOLLISIONEVENT e = &event;
 
 	if (e->t > 0 && e->t <= 1.0f)
 	{
 		float mleft, mtop, mright, mbottom;
 		GetBoundingBox(mleft, mtop, mright, mbottom);
 		float sleft, stop, sbottom, sright;
-		e->obj->GetBoundingBox(sleft, stop, sright, sbottom);
+		e->obj->GetCachedBoundingBox(sleft, stop, sright, sbottom);
 		if (e->nx != 0)
 		{
 			mario->BasicCollision(e->t, e->t, -e->nx, -e->ny, mario->x, mario->y);
@@ -67,11 +69,11 @@ void CSwitchBlock::HideGoldBox(vector<LPGAMEOBJECT>* coObjects)
 	{
 		for (size_t i = 1; i < coObjects->size(); i++)
 		{
-			if (!coObjects->at(i)->IsInCamera())
+			if (!coObjects->at(i)->IsBoxInCamera())
 				continue;
-			if (dynamic_cast<CRewardBox*>(coObjects->at(i)))
+			if (coObjects->at(i)->kind == OBJECT_KIND_REWARD_BOX)
 			{
-				CRewardBox* box = dynamic_cast<CRewardBox*>(coObjects->at(i));
+				CRewardBox* box = (CRewardBox*)coObjects->at(i);
 				if (box->isEnable && box->GetRewardType() == REWARD_BOX_TYPE_REWARD_COIN)
 				{
 
@@ -1,13 +1,9 @@
 #include <Windows.h>
 
-#include <d3d9.h>
-#include <d3dx9.h>
-
 #include "Utils.h"
 #include "Game.h"
-#include "textures.h"
-
-CTextures * CTextures::__instance = NULL;
+#include "Textures.h"
+#include "World.h"
 
 CTextures::CTextures()
 {
@@ -16,42 +12,15 @@ CTextures::CTextures()
 
 CTextures *CTextures::GetInstance()
 {
-	if (__instance == NULL) __instance = new CTextures();
-	return __instance;
+	return &CWorld::GetCurrent()->textures;
 }
 
-void CTextures::Add(int id, LPCWSTR filePath, D3DCOLOR transparentColor)
+void CTextures::Add(int id, LPCWSTR filePath, COLOR transparentColor)
 {
-	D3DXIMAGE_INFO info;
-	HRESULT result = D3DXGetImageInfoFromFile(filePath, &info);
-	if (result != D3D_OK)
+	LPTEXTURE texture = CGame::GetInstance()->GetRenderer()->LoadTexture(filePath, transparentColor);
+	if (texture == NULL)
 	{
-		DebugOut(L"[ERROR] GetImageInfoFromFile failed: %s\n", filePath);
-		return;
-	}
-
-	LPDIRECT3DDEVICE9 d3ddv = CGame::GetInstance()->GetDirect3DDevice();
-	LPDIRECT3DTEXTURE9 texture;
-
-	result = D3DXCreateTextureFromFileEx(
-		d3ddv,								// Pointer to Direct3D device object
-		filePath,							// Path to the image to load
-		info.Width,							// Texture width
-		info.Height,						// Texture height
-		1,
-		D3DUSAGE_DYNAMIC,
-		D3DFMT_UNKNOWN,
-		D3DPOOL_DEFAULT,
-		D3DX_DEFAULT,
-		D3DX_DEFAULT,
-		transparentColor,			
-		&info,
-		NULL,
-		&texture);								// Created texture pointer
-
-	if (result != D3D_OK)
-	{
-		OutputDebugString(L"[ERROR] CreateTextureFromFile failed\n");
+		DebugOut(L"[ERROR] Texture %d could not be loaded: %s\n", id, filePath);
 		return;
 	}
 
@@ -60,7 +29,7 @@ void CTextures::Add(int id, LPCWSTR filePath, D3DCOLOR transparentColor)
 	DebugOut(L"[INFO] Texture loaded Ok: id=%d, %s\n", id, filePath);
 }
 
-LPDIRECT3DTEXTURE9 CTextures::Get(unsigned int id) 
+LPTEXTURE CTextures::Get(unsigned int id) 
 {
 	return textures[id];
 }
@@ -72,11 +41,15 @@ void CTextures::Clear()
 {
 	for (auto x : textures)
 	{
-		LPDIRECT3DTEXTURE9 tex = x.second; 
-		if (tex!=NULL) tex->Release();
+		LPTEXTURE tex = x.second; 
+		delete tex;
 	}
 	
 	textures.clear();
+
+	for (size_t i = 0; i < atlases.size(); i++)
+		delete atlases[i];
+	atlases.clear();
 }
 
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <unordered_map>
-#include <d3dx9.h>
+#include <vector>
+#include "Renderer.h"
 
 using namespace std;
 
@@ -9,14 +10,16 @@ using namespace std;
 */
 class CTextures
 {
-	static CTextures * __instance;
 
-	unordered_map<int, LPDIRECT3DTEXTURE9> textures;
+	unordered_map<int, LPTEXTURE> textures;
+	vector<LPTEXTURE> atlases;		// made from the textures when a scene is loaded, see CAtlasPacker
 
 public: 
 	CTextures();
-	void Add(int id, LPCWSTR filePath, D3DCOLOR transparentColor);
-	LPDIRECT3DTEXTURE9 Get(unsigned int i);
+	void Add(int id, LPCWSTR filePath, COLOR transparentColor);
+	LPTEXTURE Get(unsigned int i);
+	void AddAtlas(LPTEXTURE atlas) { atlases.push_back(atlas); }
+	int GetAtlasCount() { return (int)atlases.size(); }
 
 	void Clear();
 	static CTextures * GetInstance();
@@ -0,0 +1,234 @@
+#include "TimerWheel.h"
+#include "Snapshot.h"
+
+#define TIMER_HANDLE_INDEX_BITS	16
+#define TIMER_HANDLE_INDEX_MASK	((1 << TIMER_HANDLE_INDEX_BITS) - 1)
+#define TIMER_HANDLE_MAX_GENERATION	0x7fff
+
+CTimerWheel::CTimerWheel()
+{
+	Reset(0);
+}
+
+/*
+	Drop every timer and restart the wheel at time (ms)
+*/
+void CTimerWheel::Reset(ULONGLONG time)
+{
+	Clear();
+	now = time;
+}
+
+/*
+	Forget every timer without calling back or touching the owners, they may be deleted already
+*/
+void CTimerWheel::Clear()
+{
+	freeTimers.clear();
+	for (size_t i = 0; i < timers.size(); i++)
+	{
+		timers[i].armed = false;
+		timers[i].owner = NULL;
+		timers[i].generation = (timers[i].generation + 1) & TIMER_HANDLE_MAX_GENERATION;
+		freeTimers.push_back(i);
+	}
+	for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+		for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+			slots[level][slot] = TIMER_NONE;
+}
+
+/*
+	Put the timer in the slot of its due time, at the lowest level whose range reaches it
+*/
+void CTimerWheel::Link(int index)
+{
+	CTimer& timer = timers[index];
+	ULONGLONG due = timer.due < now ? now : timer.due;
+	ULONGLONG delta = due - now;
+	if (delta > TIMER_WHEEL_MAX_DELAY)
+	{
+		delta = TIMER_WHEEL_MAX_DELAY;
+		due = now + delta;
+	}
+
+	int level = 0;
+	while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1ULL << ((level + 1) * TIMER_WHEEL_SLOT_BITS)))
+		level++;
+	int slot = (int)(due >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+
+	int& head = slots[level][slot];
+	timer.level = level;
+	timer.slot = slot;
+	timer.prev = TIMER_NONE;
+	timer.next = head;
+	if (head != TIMER_NONE)
+		timers[head].prev = index;
+	head = index;
+}
+
+void CTimerWheel::Unlink(int index)
+{
+	CTimer& timer = timers[index];
+	if (timer.prev != TIMER_NONE)
+		timers[timer.prev].next = timer.next;
+	else
+		slots[timer.level][timer.slot] = timer.next;
+	if (timer.next != TIMER_NONE)
+		timers[timer.next].prev = timer.prev;
+	timer.prev = timer.next = TIMER_NONE;
+}
+
+void CTimerWheel::Release(int index)
+{
+	CTimer& timer = timers[index];
+	timer.armed = false;
+	timer.owner->armedTimers--;
+	timer.owner = NULL;
+	timer.generation = (timer.generation + 1) & TIMER_HANDLE_MAX_GENERATION;
+	freeTimers.push_back(index);
+}
+
+/*
+	Schedule owner->callback() for the first ms after delay ms have passed, the same
+	moment a "now - start > delay" check would have seen it. Returns the handle to cancel it
+*/
+int CTimerWheel::Schedule(LPGAMEOBJECT owner, DWORD delay, LPTIMERCALLBACK callback)
+{
+	int index;
+	if (!freeTimers.empty())
+	{
+		index = freeTimers.back();
+		freeTimers.pop_back();
+	}
+	else
+	{
+		index = timers.size();
+		CTimer timer;
+		timer.generation = 0;
+		timers.push_back(timer);
+	}
+
+	CTimer& timer = timers[index];
+	timer.due = now + delay + 1;
+	timer.owner = owner;
+	timer.callback = callback;
+	timer.armed = true;
+	owner->armedTimers++;
+	Link(index);
+
+	return (timer.generation << TIMER_HANDLE_INDEX_BITS) | index;
+}
+
+bool CTimerWheel::IsArmed(int handle)
+{
+	if (handle == TIMER_NONE)
+		return false;
+	int index = handle & TIMER_HANDLE_INDEX_MASK;
+	if (index >= (int)timers.size())
+		return false;
+	CTimer& timer = timers[index];
+	return timer.armed && timer.generation == (handle >> TIMER_HANDLE_INDEX_BITS);
+}
+
+void CTimerWheel::Cancel(int handle)
+{
+	if (!IsArmed(handle))
+		return;
+	int index = handle & TIMER_HANDLE_INDEX_MASK;
+	Unlink(index);
+	Release(index);
+}
+
+/*
+	Cancel every timer of owner, for objects deleted while they still have timers armed
+*/
+void CTimerWheel::CancelAll(LPGAMEOBJECT owner)
+{
+	for (size_t i = 0; i < timers.size(); i++)
+	{
+		if (timers[i].armed && timers[i].owner == owner)
+		{
+			Unlink(i);
+			Release(i);
+		}
+	}
+}
+
+/*
+	Move the timers of the current slot of level down to the levels below
+*/
+void CTimerWheel::Cascade(int level)
+{
+	int slot = (int)(now >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+	int index = slots[level][slot];
+	slots[level][slot] = TIMER_NONE;
+	while (index != TIMER_NONE)
+	{
+		int next = timers[index].next;
+		Link(index);
+		index = next;
+	}
+}
+
+/*
+	Run the clock up to time, firing the timers due on the way in order
+*/
+void CTimerWheel::Advance(ULONGLONG time)
+{
+	if (freeTimers.size() == timers.size())
+	{
+		// nothing armed
+		if (time > now)
+			now = time;
+		return;
+	}
+
+	while (now < time)
+	{
+		now++;
+
+		int slot = (int)now & TIMER_WHEEL_SLOT_MASK;
+		for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+		{
+			if (((now >> ((level - 1) * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK) != 0)
+				break;
+			Cascade(level);
+		}
+
+		// take the timers one by one, a callback may cancel or schedule others
+		while (slots[0][slot] != TIMER_NONE)
+		{
+			int index = slots[0][slot];
+			Unlink(index);
+
+			CTimer& timer = timers[index];
+			if (timer.due > now)
+			{
+				// was clamped to the farthest slot, not due yet
+				Link(index);
+				continue;
+			}
+
+			LPGAMEOBJECT owner = timer.owner;
+			LPTIMERCALLBACK callback = timer.callback;
+			Release(index);
+			(owner->*callback)();
+		}
+	}
+}
+
+void CTimerWheel::Save(CSnapshot& s)
+{
+	s.WriteVector(timers);
+	s.WriteVector(freeTimers);
+	s.Write(slots);
+	s.Write(now);
+}
+
+void CTimerWheel::Load(CSnapshot& s)
+{
+	s.ReadVector(timers);
+	s.ReadVector(freeTimers);
+	s.Read(slots);
+	s.Read(now);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "GameObject.h"
+
+using namespace std;
+
+#define TIMER_WHEEL_LEVELS		4
+#define TIMER_WHEEL_SLOT_BITS	6
+#define TIMER_WHEEL_SLOTS		(1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK	(TIMER_WHEEL_SLOTS - 1)
+// farthest due time a timer can be linked at, later ones are relinked when their slot comes up
+#define TIMER_WHEEL_MAX_DELAY	((1ULL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1)
+
+#define TIMER_NONE	-1
+
+struct CTimer
+{
+	ULONGLONG due;
+	LPGAMEOBJECT owner;
+	LPTIMERCALLBACK callback;
+	int generation;			// bumped when the timer is freed, so old handles stop matching
+	bool armed;
+	int level, slot;		// slot list the timer is linked in
+	int prev, next;
+};
+
+/*
+	Hierarchical timer wheel in ms. Level 0 has one slot per ms, each next level one slot per
+	TIMER_WHEEL_SLOTS slots of the level below. A timer sits in the slot of its due time at
+	the lowest level that reaches it and moves down when that slot comes up, so Advance only
+	touches the timers that fire (or cascade) and never the armed ones still waiting.
+*/
+class CTimerWheel
+{
+	vector<CTimer> timers;
+	vector<int> freeTimers;
+	int slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	ULONGLONG now = 0;			// last ms processed
+
+	void Link(int index);
+	void Unlink(int index);
+	void Release(int index);
+	void Cascade(int level);
+
+public:
+	CTimerWheel();
+
+	void Reset(ULONGLONG time);
+	void Clear();
+
+	int Schedule(LPGAMEOBJECT owner, DWORD delay, LPTIMERCALLBACK callback);
+	void Cancel(int handle);
+	void CancelAll(LPGAMEOBJECT owner);
+	bool IsArmed(int handle);
+
+	void Advance(ULONGLONG time);
+
+	void Save(CSnapshot& s);
+	void Load(CSnapshot& s);
+};
@@ -60,4 +60,37 @@ LPCWSTR ToLPCWSTR(string st)
 
 	// delete wcstring   // << can I ? 
 	return w->c_str();
-}
\ No newline at end of file
+}
+
+#ifndef _WIN32
+static string NarrowPath(LPCWSTR path)
+{
+	string narrow;
+	for (const wchar_t* c = path; *c != 0; c++)
+		narrow += (*c == L'\\') ? '/' : (char)*c;
+	return narrow;
+}
+#endif
+
+/*
+	Open a data file by its path in the game files (backslash separated, relative to the
+	game folder). Only Windows opens a stream by a wide path, elsewhere it is narrowed and
+	the separators turned to '/'
+*/
+void OpenDataFile(ifstream& f, LPCWSTR path, ios_base::openmode mode)
+{
+#ifdef _WIN32
+	f.open(path, mode);
+#else
+	f.open(NarrowPath(path), mode);
+#endif
+}
+
+void OpenDataFile(ofstream& f, LPCWSTR path, ios_base::openmode mode)
+{
+#ifdef _WIN32
+	f.open(path, mode);
+#else
+	f.open(NarrowPath(path), mode);
+#endif
+}
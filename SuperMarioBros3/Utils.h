@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <vector>
 #include <string>
+#include <fstream>
 
 
 using namespace std;
@@ -21,3 +22,6 @@ wstring ToWSTR(string st);
 
 LPCWSTR ToLPCWSTR(string st);
 
+void OpenDataFile(ifstream& f, LPCWSTR path, ios_base::openmode mode = ios_base::in);
+void OpenDataFile(ofstream& f, LPCWSTR path, ios_base::openmode mode = ios_base::out);
+
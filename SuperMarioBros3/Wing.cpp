@@ -1,4 +1,5 @@
 #include "Wing.h"
+#include "Game.h"
 #include "Utils.h"
 
 CWing::CWing(int _type)
@@ -58,7 +59,7 @@ void CWing::Render()
 }
 void CWing::GetBoundingBox(float& left, float& top, float& right, float& bottom)
 {
-
+	left = top = right = bottom = 0;
 }
 
 void CWing::SetState(int state)
@@ -67,7 +68,7 @@ void CWing::SetState(int state)
 	if (state == WING_STATE_FLYING)
 	{
 		StageOfFlying = 1;
-		fly_start =(DWORD) GetTickCount64();
+		fly_start =(DWORD) CGame::GetInstance()->GetSceneTime();
 	}
 }
 
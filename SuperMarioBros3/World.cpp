@@ -0,0 +1,49 @@
+#include <assert.h>
+
+#include "World.h"
+
+thread_local CWorld* CWorld::current = NULL;
+
+CWorld::CWorld() :
+	heap(),
+	game(),
+	textures(),
+	sprites(),
+	animations(),
+	animationSets(),
+	zones(),
+	pointsEffects(),
+	backUp()
+{
+}
+
+/*
+	Unload the running scene and free the resources, with this world current since the
+	objects deleted on the way reach it through GetInstance
+*/
+CWorld::~CWorld()
+{
+	CWorld* previous = current;
+	current = this;
+
+	LPSCENE scene = game.GetCurrentScene();
+	if (scene != NULL)
+	{
+		scene->Unload();
+		scene->GetTimers()->Clear();
+	}
+
+	pointsEffects.Clear();
+	textures.Clear();
+	sprites.Clear();
+	animations.Clear();
+	zones.Clear();
+
+	current = (previous == this) ? NULL : previous;
+}
+
+CWorld* CWorld::GetCurrent()
+{
+	assert(current != NULL);		// the game code ran on a thread that made no world current
+	return current;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "ObjectHeap.h"
+#include "Game.h"
+#include "Textures.h"
+#include "Sprites.h"
+#include "Animations.h"
+#include "Zone.h"
+#include "PointsEffect.h"
+#include "BackUp.h"
+
+/*
+	One running game: the CGame with its scenes and every registry the game code reaches
+	through GetInstance. GetInstance returns the registry of the world current on the
+	calling thread, so several worlds can run side by side, one per thread, and the game
+	code does not have to know which one it is in. The game objects are allocated from the
+	world's heap, which is declared first so it goes last.
+*/
+class CWorld
+{
+	static thread_local CWorld* current;
+
+public:
+	CObjectHeap heap;
+	CGame game;
+	CTextures textures;
+	CSprites sprites;
+	CAnimations animations;
+	CAnimationSets animationSets;
+	CZones zones;
+	CPointsEffects pointsEffects;
+	CBackUp backUp;
+
+	CWorld();
+	~CWorld();
+
+	// the calling thread works on this world from now on
+	void MakeCurrent() { current = this; }
+
+	// world of the calling thread, which has to make one current before it runs any game code
+	static CWorld* GetCurrent();
+};
+typedef CWorld * LPWORLD;
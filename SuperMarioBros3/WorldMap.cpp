@@ -11,6 +11,7 @@
 #include "Station.h"
 #include "Bush.h"
 #include "BackUp.h"
+#include "AtlasPacker.h"
 
 using namespace std;
 
@@ -55,7 +56,7 @@ void CWorldMap::_ParseSection_TEXTURES(string line)
 	int G = atoi(tokens[3].c_str());
 	int B = atoi(tokens[4].c_str());
 
-	CTextures::GetInstance()->Add(texID, path.c_str(), D3DCOLOR_XRGB(R, G, B));
+	CTextures::GetInstance()->Add(texID, path.c_str(), COLOR_XRGB(R, G, B));
 }
 void CWorldMap::_ParseSection_MAP(string line)
 {
@@ -76,6 +77,8 @@ void CWorldMap::_ParseSection_MAP(string line)
 	this->map = new Map(idMap, tileWidth, tileHeight, tRTileSet, tCTileSet, tRMap, tCMap, totalTiles);
 	map->LoadMatrix(MatrixPath.c_str());
 	map->CreateTilesFromTileSet();
+	// the world map has no HUD above it and starts a tile left of the screen
+	map->SetDrawOffset(-(float)tileWidth, 0);
 }
 void CWorldMap::_ParseSection_ZONE(string line)
 {
@@ -103,7 +106,7 @@ void CWorldMap::_ParseSection_SPRITES(string line)
 	int b = atoi(tokens[4].c_str());
 	int texID = atoi(tokens[5].c_str());
 
-	LPDIRECT3DTEXTURE9 tex = CTextures::GetInstance()->Get(texID);
+	LPTEXTURE tex = CTextures::GetInstance()->Get(texID);
 	if (tex == NULL)
 	{
 		DebugOut(L"[ERROR] Texture ID %d not found!\n", texID);
@@ -217,7 +220,7 @@ void CWorldMap::Load()
 	DebugOut(L"[INFO] Start loading scene resources from : %s \n", sceneFilePath);
 
 	ifstream f;
-	f.open(sceneFilePath);
+	OpenDataFile(f, sceneFilePath);
 
 	// current resource section flag
 	int section = SCENE_SECTION_UNKNOWN;
@@ -257,7 +260,17 @@ void CWorldMap::Load()
 
 	CBackUp::GetInstance()->LoadBackUpMarioWM(player);
 
-	CTextures::GetInstance()->Add(ID_TEX_BBOX, L"textures\\bbox.png", D3DCOLOR_XRGB(255, 255, 255));
+	CTextures::GetInstance()->Add(ID_TEX_BBOX, L"textures\\bbox.png", COLOR_XRGB(255, 255, 255));
+
+	// the sprites and tiles of the scene drawn from an atlas or two instead of one texture per sheet
+	if (CGame::GetInstance()->GetPackAtlases())
+	{
+		CAtlasPacker packer;
+		packer.AddAll(CSprites::GetInstance());
+		if (map)
+			packer.AddAll(map->GetTiles());
+		packer.Pack();
+	}
 
 	DebugOut(L"[INFO] Done loading scene resources %s\n", sceneFilePath);
 
@@ -271,13 +284,16 @@ void CWorldMap::Update(DWORD dt)
 	vector<LPGAMEOBJECT> coObjects;
 	for (size_t i = 0; i < objects.size(); i++)
 	{
+		objects[i]->RefreshBoundingBox();
 		coObjects.push_back(objects[i]);
 	}
 	for (size_t i = 0; i < objects.size(); i++)
 	{
 
 		objects[i]->Update(dt, &coObjects);
+		objects[i]->RefreshBoundingBox();
 	}
+	updatedObjects = objects.size();
 
 	// skip the rest if scene was already unloaded (Mario::Update might trigger PlayScene::Unload)
 	if (player == NULL) return;
@@ -307,7 +323,7 @@ void CWorldMap::Render()
 		this->map->Render();
 	for (unsigned int i = 0; i < objects.size(); i++)
 	{
-		objects[i]->Render();
+		objects[i]->RenderInterpolated();
 	}
 
 	if(hud)
@@ -1,5 +1,6 @@
 #include "Zone.h"
 #include "Utils.h"
+#include "World.h"
 
 CZone::CZone(int _left, int _top, int _right, int _bottom)
 {
@@ -17,8 +18,6 @@ void CZone::GetZone(int& _left, int& _top, int& _right, int& _bottom)
 	_bottom = bottom;
 }
 
-CZones* CZones::__instance = nullptr;
-
 void CZones::Add(int id, CZone* zone)
 {
 	zones[id] = zone;
@@ -43,7 +42,5 @@ void CZones::Clear()
 }
 CZones* CZones::GetInstance()
 {
-	if (__instance == nullptr)
-		__instance = new CZones();
-	return __instance;
+	return &CWorld::GetCurrent()->zones;
 }
\ No newline at end of file
@@ -21,7 +21,6 @@ public:
 
 class CZones
 {
-	static CZones* __instance;
 	map<int, CZone*> zones;
 
 public:
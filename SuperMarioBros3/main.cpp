@@ -8,15 +8,26 @@
 		1/ Implement a scence manager 
 		2/ Load scene from "database", add/edit/remove scene without changing code 
 		3/ Dynamically move between scenes without hardcode logic 
+
+	Command line: -record <log> saves the keys of the run to an input log, -replay <log>
+	plays one back from the scene it was recorded in, -turbo [k] starts in turbo mode
+
+	Turbo mode (F9 turns it on and off) runs the simulation steps back to back, as fast as
+	the machine goes, and renders every k-th step only (never when k is 0). It renders once a
+	slice of steps at most, so a Present waiting for the vertical blank costs one refresh a
+	slice. The window title shows how many seconds of game time pass per second.
 		
 ================================================================ */
 
 #include <windows.h>
-#include <d3d9.h>
-#include <d3dx9.h>
+#include <shellapi.h>
 
 #include "Utils.h"
-#include "Game.h"
+#include "World.h"
+#include "InputLog.h"
+#include "D3D9Renderer.h"
+#include "BatchRenderer.h"
+#include "DirectInputKeyboard.h"
 #include "GameObject.h"
 #include "Textures.h"
 
@@ -29,20 +40,38 @@
 #define WINDOW_CLASS_NAME L"SampleWindow"
 #define MAIN_WINDOW_TITLE L"Super Mario Bros 3"
 
-#define BACKGROUND_COLOR D3DCOLOR_XRGB(0,0,0)
+#define BACKGROUND_COLOR COLOR_XRGB(0,0,0)
 #define SCREEN_WIDTH 270
 #define SCREEN_HEIGHT 250
 
 #define MAX_FRAME_RATE 120
 
+// steps run for one rendered frame at most, time beyond that (a hitch, a scene load) is dropped
+#define MAX_STEPS_PER_FRAME 5
+
+#define TURBO_TOGGLE_KEY			VK_F9
+#define TURBO_DEFAULT_RENDER_EVERY	10
+#define TURBO_SLICE					16		// ms of steps between two looks at the window messages
+#define TURBO_REPORT_PERIOD			1000	// ms between two speed reports in the title
+
 CGame *game;
 
+bool turbo = false;
+int turboRenderEvery = TURBO_DEFAULT_RENDER_EVERY;
+
 LRESULT CALLBACK WinProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
 	switch (message) {
 	case WM_DESTROY:
 		PostQuitMessage(0);
 		break;
+	case WM_KEYDOWN:
+		if (wParam == TURBO_TOGGLE_KEY)
+		{
+			turbo = !turbo;
+			break;
+		}
+		return DefWindowProc(hWnd, message, wParam, lParam);
 	default:
 		return DefWindowProc(hWnd, message, wParam, lParam);
 	}
@@ -56,7 +85,20 @@ LRESULT CALLBACK WinProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 */
 void Update(DWORD dt)
 {
-	CGame::GetInstance()->GetCurrentScene()->Update(dt);
+	LPSCENE scene = CGame::GetInstance()->GetCurrentScene();
+	scene->AdvanceClock(dt);
+	scene->Update(dt);
+}
+
+/*
+	One fixed simulation step
+*/
+void Step()
+{
+	game->SaveCamPos();
+	game->ProcessKeyboard();
+
+	Update(SIMULATION_STEP);
 }
 
 /*
@@ -64,25 +106,27 @@ void Update(DWORD dt)
 */
 void Render()
 {
-	LPDIRECT3DDEVICE9 d3ddv = game->GetDirect3DDevice();
-	LPDIRECT3DSURFACE9 bb = game->GetBackBuffer();
-	LPD3DXSPRITE spriteHandler = game->GetSpriteHandler();
+	LPRENDERER renderer = game->GetRenderer();
 
-	if (SUCCEEDED(d3ddv->BeginScene()))
-	{
-		// Clear back buffer with a color
-		d3ddv->ColorFill(bb, NULL, BACKGROUND_COLOR);
+	// Clear back buffer with a color
+	renderer->BeginFrame(BACKGROUND_COLOR);
 
-		spriteHandler->Begin(D3DXSPRITE_ALPHABLEND);
+	// draw the camera where it was between the last two steps, like the objects
+	float cx, cy, px, py;
+	game->GetCamPos(cx, cy);
+	game->GetPrevCamPos(px, py);
+	if (abs(cx - px) <= RENDER_SNAP_DISTANCE && abs(cy - py) <= RENDER_SNAP_DISTANCE)
+	{
+		float alpha = game->GetRenderAlpha();
+		game->SetCamPos(round(px + (cx - px) * alpha), round(py + (cy - py) * alpha));
+	}
 
-		CGame::GetInstance()->GetCurrentScene()->Render();
+	CGame::GetInstance()->GetCurrentScene()->Render();
 
-		spriteHandler->End();
-		d3ddv->EndScene();
-	}
+	game->SetCamPos(cx, cy);
 
 	// Display back buffer content to the screen
-	d3ddv->Present(NULL, NULL, NULL, NULL);
+	renderer->EndFrame();
 }
 
 HWND CreateGameWindow(HINSTANCE hInstance, int nCmdShow, int ScreenWidth, int ScreenHeight)
@@ -132,40 +176,118 @@ HWND CreateGameWindow(HINSTANCE hInstance, int nCmdShow, int ScreenWidth, int Sc
 	return hWnd;
 }
 
-int Run()
+double ElapsedMs(LARGE_INTEGER from, LARGE_INTEGER to, LARGE_INTEGER frequency)
+{
+	return (to.QuadPart - from.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+int Run(HWND hWnd)
 {
 	MSG msg;
 	int done = 0;
-	DWORD frameStart = (DWORD)GetTickCount64();
-	DWORD tickPerFrame = 1000 / MAX_FRAME_RATE;
+	LARGE_INTEGER frequency, frameStart, now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&frameStart);
+	double tickPerFrame = 1000.0 / MAX_FRAME_RATE;
+	double accumulator = 0;
+
+	bool wasTurbo = false;
+	LARGE_INTEGER reportStart;
+	int reportSteps = 0;
+	ULONGLONG turboSteps = 0;
 
 	while (!done)
 	{
-		if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+		// every waiting message, a turbo slice can leave many behind
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
 		{
 			if (msg.message == WM_QUIT) done = 1;
 
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
 		}
+		if (done)
+			break;
+
+		if (turbo)
+		{
+			if (!wasTurbo)
+			{
+				QueryPerformanceCounter(&reportStart);
+				reportSteps = 0;
+				wasTurbo = true;
+			}
+
+			// the steps of one slice back to back, the frame shows the last step as it is
+			game->SetRenderAlpha(1.0f);
+			LARGE_INTEGER sliceStart;
+			QueryPerformanceCounter(&sliceStart);
+			bool renderDue = false;
+			do
+			{
+				Step();
+				reportSteps++;
+				turboSteps++;
+				if (turboRenderEvery > 0 && turboSteps % turboRenderEvery == 0)
+					renderDue = true;
+				QueryPerformanceCounter(&now);
+			} while (ElapsedMs(sliceStart, now, frequency) < TURBO_SLICE);
+
+			// one frame for all the k-th steps of the slice
+			if (renderDue)
+				Render();
+
+			double reportTime = ElapsedMs(reportStart, now, frequency);
+			if (reportTime >= TURBO_REPORT_PERIOD)
+			{
+				double speed = reportSteps * SIMULATION_STEP / reportTime;
+				wchar_t title[128];
+				swprintf_s(title, L"%s - turbo x%.1f", MAIN_WINDOW_TITLE, speed);
+				SetWindowText(hWnd, title);
+				DebugOut(L"[INFO] Turbo: %.1f s of game time per second\n", speed);
+				reportStart = now;
+				reportSteps = 0;
+			}
+
+			// back to normal speed without catching up on the time turbo took
+			frameStart = now;
+			accumulator = 0;
+			continue;
+		}
+		if (wasTurbo)
+		{
+			SetWindowText(hWnd, MAIN_WINDOW_TITLE);
+			wasTurbo = false;
+		}
 
-		DWORD now =(DWORD) GetTickCount64();
+		QueryPerformanceCounter(&now);
 
 		// dt: the time between (beginning of last frame) and now
 		// this frame: the frame we are about to render
-		DWORD dt = now - frameStart;
+		double dt = ElapsedMs(frameStart, now, frequency);
 
 		if (dt >= tickPerFrame)
 		{
 			frameStart = now;
 
-			game->ProcessKeyboard();
-			
-			Update(dt);
+			// run as many fixed steps as the elapsed time holds, the rest waits for the next frame
+			accumulator += dt;
+			int steps = 0;
+			while (accumulator >= SIMULATION_STEP && steps < MAX_STEPS_PER_FRAME)
+			{
+				Step();
+
+				accumulator -= SIMULATION_STEP;
+				steps++;
+			}
+			if (accumulator >= SIMULATION_STEP)
+				accumulator = 0;
+
+			game->SetRenderAlpha((float)(accumulator / SIMULATION_STEP));
 			Render();
 		}
 		else
-			Sleep(tickPerFrame - dt);	
+			Sleep((DWORD)(tickPerFrame - dt));	
 	}
 
 	return 1;
@@ -175,15 +297,68 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 {
 	HWND hWnd = CreateGameWindow(hInstance, nCmdShow, SCREEN_WIDTH, SCREEN_HEIGHT);
 
-	game = CGame::GetInstance();
-	game->Init(hWnd);
+	wstring recordPath, replayPath;
+	int argc;
+	LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+	for (int i = 1; argv != NULL && i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (wcscmp(argv[i], L"-record") == 0 && hasValue) recordPath = argv[++i];
+		else if (wcscmp(argv[i], L"-replay") == 0 && hasValue) replayPath = argv[++i];
+		else if (wcscmp(argv[i], L"-turbo") == 0)
+		{
+			turbo = true;
+			if (hasValue && iswdigit(argv[i + 1][0]))		// k is optional
+				turboRenderEvery = max(_wtoi(argv[++i]), 0);
+		}
+	}
+	LocalFree(argv);
+
+	LPINPUT input = new CDirectInputKeyboard();
+	CInputReplay* replay = NULL;
+	if (!replayPath.empty())
+	{
+		replay = new CInputReplay();
+		if (replay->Open(replayPath.c_str()))
+		{
+			delete input;
+			input = replay;
+		}
+		else
+		{
+			delete replay;
+			replay = NULL;
+		}
+	}
+	CInputRecorder* recorder = NULL;
+	if (!recordPath.empty())
+		input = recorder = new CInputRecorder(input);
+
+	CWorld* world = new CWorld();
+	world->MakeCurrent();
+
+	game = &world->game;
+	CBatchRenderer* renderer = new CBatchRenderer(new CD3D9Renderer());
+	game->Init(hWnd, renderer, input);
 	game->InitKeyboard();
 
 	game->Load(L"globalData\\mario-sample.txt");
 
+	if (replay != NULL && replay->GetSceneId() != game->GetCurrentSceneId())
+		game->SwitchScene(replay->GetSceneId());
+	if (recorder != NULL)
+		recorder->Open(recordPath.c_str(), game->GetCurrentSceneId());
+
 	SetWindowPos(hWnd, 0, 0, 0, SCREEN_WIDTH*2, SCREEN_HEIGHT*2, SWP_NOMOVE | SWP_NOOWNERZORDER | SWP_NOZORDER);
 
-	Run();
+	Run(hWnd);
+
+	CRenderStats stats = renderer->GetTotalStats();
+	int frames = max(renderer->GetFrames(), 1);
+	DebugOut(L"[INFO] Per frame: %.1f sprites in %.1f batches, %.1f texture switches (%.1f unbatched)\n",
+		(float)stats.quads / frames, (float)stats.batches / frames,
+		(float)stats.textureSwitches / frames, (float)stats.textureSwitchesSubmitted / frames);
 
+	delete world;
 	return 0;
 }
\ No newline at end of file